@@ -15,21 +15,117 @@
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
 #include <Wire.h>
+#include "CarduinoAnalogScanner.h"
+#include "CarduinoAutoRules.h"
+#include "CarduinoCommands.h"
+#include "CarduinoDebounce.h"
+#include "CarduinoDeviceState.h"
+#include "CarduinoInputChain.h"
+#include "CarduinoInputSampler.h"
+#include "CarduinoProtocol.h"
+#include "CarduinoSync.h"
+#include "CarduinoTaskScheduler.h"
+#include "CarduinoTimerWheel.h"
 
 // function prototypes
 void readInputs();
 void calculations();
 void updateOutputs();
-void sendI2CMessage(byte address, byte pattern, byte option=255);
+void handleOffRoadMode();
+void handleHazardMode();
+void handleObservatoryMode();
+void handleAllOnMode();
+void handleOffRoadModeSelect();
+void handleHazardModeSelect();
+void handleBumperLightBar();
+void handleMainLightBar();
+void handleSideLightBars();
+void handleRearLightBar();
+void handleGMRSRadio();
+void handleTunesRadio();
+void handleNightSignal();
+void handleMomentarySideLightBars();
+void handleDriversMapLight();
+void handleDomeLightSelect();
+void handlePassengerMapLight();
+byte modeScene(byte m);
+byte activeScene();
+byte activeSceneRelays(byte bar);
+void updateModeLayers();
+void updateSideLights();
+void updateAreaLights();
+void updateOutputShiftRegisters();
+void updateAutoRules();
+boolean nightSignalOn();
+boolean sendI2CFrame(byte address, const byte *frame, byte length);
+unsigned int checkSuppressedI2CCommands();
+void sendI2CFrames();
+void sendTimeSync();
+void taskSensors();
+void taskLogic();
+void taskI2C();
+void taskHUD();
+void taskPower();
+void taskReport();
 
 // Debug Mode Select
 boolean debugSwitches = false; // Change to true will allow messages to print to the serial monitor
 boolean debugI2C = false; // Change to true will allow messages to print to the serial monitor
+boolean debugTasks = false; // Change to true will print the loop task timings to the serial monitor every TASK_REPORT_PERIOD
 boolean i2c_active = true; // Change to false to remove I2C calls for troubleshooting
 
 // Define I2C device constants
 #define I2C_MESSAGE_RECEIVED_LED_FLASH_LENGTH 250 // The milliseconds time that the light will flash for
 #define LIGHT_SLEEP_TIME_INTERVAL 900000 // The miliseconds time that lights should sleep after no activity (15 minutes)
+#define I2C_DEVICE_MAX 8 // Most devices in the I2C device registry, one bit each in an I2C_SELECT_TARGETS mask
+#define SLEEP_TIMER_TICK_SHIFT 10 // Sleep timers tick every 1024 ms, so 15 minutes fits in 16 bits
+#define LIGHT_SLEEP_TICKS TIMER_WHEEL_TICKS(LIGHT_SLEEP_TIME_INTERVAL, SLEEP_TIMER_TICK_SHIFT)
+
+// I2C device registry - the address of every Nano on the bus, one line per
+// device.  Power, sleep and sending the frames go over every device in it, so
+// a new device is a new line here, plus a position below if other code needs
+// to refer to it.  i2cDevices[] holds the devices in the same order.
+constexpr byte i2cDeviceAddresses[] PROGMEM = {
+  I2C_MAIN_BAR_ADDRESS,
+  I2C_REAR_BAR_ADDRESS,
+  I2C_SIDE_BARS_ADDRESS
+};
+
+#define I2C_DEVICE_COUNT (sizeof(i2cDeviceAddresses) / sizeof(i2cDeviceAddresses[0]))
+
+// Table positions
+#define I2C_DEVICE_MAIN_BAR 0
+#define I2C_DEVICE_REAR_BAR 1
+#define I2C_DEVICE_SIDE_BARS 2
+
+// A device's bit in an I2C_SELECT_TARGETS mask comes from its address, so
+// every address has to be one of the I2C_DEVICE_MAX from I2C_MAIN_BAR_ADDRESS
+constexpr boolean i2cDeviceAddressesValid(byte d = 0){
+  return d == I2C_DEVICE_COUNT ||
+         (i2cDeviceAddresses[d] >= I2C_MAIN_BAR_ADDRESS && i2cDeviceAddresses[d] < I2C_MAIN_BAR_ADDRESS + I2C_DEVICE_MAX &&
+          i2cDeviceAddressesValid(d + 1));
+}
+
+static_assert(I2C_DEVICE_COUNT <= I2C_DEVICE_MAX, "More I2C devices than I2C_DEVICE_MAX");
+static_assert(I2C_DEVICE_MAIN_BAR < I2C_DEVICE_COUNT && I2C_DEVICE_REAR_BAR < I2C_DEVICE_COUNT && I2C_DEVICE_SIDE_BARS < I2C_DEVICE_COUNT,
+              "An I2C device position is past the end of the registry");
+static_assert(i2cDeviceAddressesValid(), "An I2C device address has no bit in an I2C_SELECT_TARGETS mask");
+
+// I2CDevice status bits
+#define I2C_DEVICE_POWERED         0x01 // RGB power has been switched on
+#define I2C_DEVICE_SCENE_HELD      0x02 // The waiting commands are part of a scene and go out with the other bars of it
+#define I2C_DEVICE_COMMAND_REFUSED 0x04 // A command found the frame full, see checkCommandRefused()
+
+// I2CDevice activity bits, one per group of lights.  Any of them keeps the device's sleep timer from running out.
+#define ACTIVE_RGB        0x01 // RGB lights running a pattern
+#define ACTIVE_RGB_LEFT   0x02
+#define ACTIVE_RGB_RIGHT  0x04
+#define ACTIVE_RGB_BRAKE  0x08
+#define ACTIVE_MAIN       0x10 // Main lights on
+#define ACTIVE_MAIN_LEFT  0x20
+#define ACTIVE_MAIN_RIGHT 0x40
+#define ACTIVE_RGB_ALL    (ACTIVE_RGB | ACTIVE_RGB_LEFT | ACTIVE_RGB_RIGHT)
+#define ACTIVE_MAIN_ALL   (ACTIVE_MAIN | ACTIVE_MAIN_LEFT | ACTIVE_MAIN_RIGHT)
 
 // Define state text for readability
 #define OFF       0 // Switch state definition for readability
@@ -55,6 +151,7 @@ boolean i2c_active = true; // Change to false to remove I2C calls for troublesho
 #define PIN 31
 #define NUM_LEDS 31
 byte HUDbrightness = 255; // brightness range of overhead indicator lights [off..on] = [0..255]
+boolean hudChanged = true; // The HUD pixels or brightness changed since the last show()
 Adafruit_NeoPixel overheadControlsStrip = Adafruit_NeoPixel(NUM_LEDS, PIN, NEO_GRBW + NEO_KHZ800);
 uint32_t hudColor = overheadControlsStrip.Color(0, 0, 0, 255); // Current hud color
 uint32_t white = overheadControlsStrip.Color(0,0,0,255); // Daytime indicator hud state
@@ -67,22 +164,24 @@ uint32_t off = overheadControlsStrip.Color(0,0,0,0);
 // Define I2C variables
 unsigned long i2c_message_LED_flash_start_timer;  // start time in milliseconds for flash
 int i2c_message_LED_status;               // status of LED: 1 = ON, 0 = OFF
+unsigned long i2c_sync_timer;             // time the last time sync went out
+byte i2c_sync_seed = 0;                   // random seed handed to the Nanos with each sync
+TimerWheel<I2C_DEVICE_COUNT> settleTimers; // RGB power settle time of each device, ticked by taskLogic()
+TimerWheel<I2C_DEVICE_COUNT, SLEEP_TIMER_TICK_SHIFT> sleepTimers; // Inactivity time of each device, ticked by taskPower()
 
 // Define other variables
 byte currentOffRoadPattern = 0; // Current off road mode, incraments with Off Road Mode Select switch
-boolean offRoadPatternUpdated = false; // Tells Off Road Mode code to run again when Off Road Mode Pattern Select has been toggled
-boolean hazardModeDirectionUpdated = false; // Tells Hazard Mode code to run again when Hazard Mode Direction Select has been toggled
+boolean modeLayersPending = false; // updateModeLayers() has to run again, a bar refused part of its scene
 
 
 // Build Classes
-class SwitchOnOffOn {
-  //Variables
-    char currentState; // 0=Off/CENTER 1=ON/LEFT/NEXT 2=AUTO/RIGHT/PREVIOUS/DOOR
-    char previousState; // 0=Off/CENTER 1=ON/LEFT/NEXT 2=AUTO/RIGHT/PREVIOUS/DOOR | Allows some signals to only be sent once
+class PanelSwitch {
+  // Variables
+  protected:
+    char currentState;
+    char previousState; // Allows some signals to only be sent once
 
   public:
-    //SwitchOnOffOn;
-
     //Methods
     void updateCurrentState(byte newState){
       currentState = newState;
@@ -101,30 +200,12 @@ class SwitchOnOffOn {
     }
 };
 
-class SwitchOnOff {
-  // Variables
-  char currentState; // 0=Off 1=ON/Mode Activate
-  char previousState; // 0=Off 1=ON/Mode Activate | Allows some signals to only be sent once
-
-  public:
-    //SwitchOnOff;
-
-    // Methods
-    void updateCurrentState(byte newState){
-      currentState = newState;
-    }
-
-    char checkState(){
-      return currentState;
-    }
-
-    char checkPreviousState(){
-      return previousState;
-    }
+class SwitchOnOffOn : public PanelSwitch {
+  // States: 0=Off/CENTER 1=ON/LEFT/NEXT 2=AUTO/RIGHT/PREVIOUS/DOOR
+};
 
-    void updatePreviousState(){
-      previousState = currentState;
-    }
+class SwitchOnOff : public PanelSwitch {
+  // States: 0=Off 1=ON/Mode Activate
 };
 
 class InteriorLight {
@@ -145,6 +226,7 @@ class InteriorLight {
       switch(stripSelect){
         case 0:
           overheadControlsStrip.setBrightness(newBrightness);
+          hudChanged = true;
           break;
       }
     }
@@ -153,6 +235,7 @@ class InteriorLight {
       switch(stripSelect){
         case 0:
           overheadControlsStrip.fill(newColor, startingPixel, numberOfPixels);
+          hudChanged = true;
           break;
       }
     }
@@ -161,86 +244,266 @@ class InteriorLight {
 class I2CDevice {
   private:
     byte address; // address of the device the messages will be sent to
-    volatile boolean powerStatus = false; // Hold the Power On state of the I2C device
-    unsigned long sleepTimer = 0; // Holds the last time value when the device was told to display nothing
-    boolean RGBLightsActive = false; // Holds if the RGB lights are currently running a pattern or not
-    boolean RGBLeftLightsActive = false; // Holds if the RGB lights are currently running a pattern or not
-    boolean RGBRightLightsActive = false; // Holds if the RGB lights are currently running a pattern or not
-    boolean RGBBrakeLightsActive = false; // Holds if the RGB lights are currently running a pattern or not
-    boolean mainLightsActive = false; // Holds if the Main lights are currently on or not
-    boolean mainLeftLightsActive = false; // Holds if the Main lights are currently on or not
-    boolean mainRightLightsActive = false; // Holds if the Main lights are currently on or not
+    byte timer; // Number of its settle timer and its sleep timer, the same on both wheels and its registry position
+    byte status = 0; // I2C_DEVICE_ status bits
+    byte activeLights = 0; // ACTIVE_ bits of the lights that are currently on or running a pattern
+    byte frame[I2C_FRAME_MAX_LENGTH]; // Commands waiting to be sent to the device in one I2C frame
+    byte frameCommandCount = 0;
+    DeviceState sentState; // What the device's lights were put in by the frames it acknowledged itself
+    DeviceState queuedState; // sentState with the waiting commands applied
+    unsigned int suppressedCommands = 0; // Commands dropped because they would change nothing
+
+    // Check if the waiting commands can go out now, without sendI2CFrames()
+    // having to check the settle time or the scene first
+    boolean checkFree(){
+      return checkReady() && !checkSceneHeld();
+    }
+
+    // Make room for a command in a full frame by dropping a waiting command it
+    // makes unneeded, one that only sets lights the new command sets as well.
+    // Returns false if there is none.
+    boolean replaceCommand(byte pattern){
+      byte sets = deviceStateSets(pattern);
+
+      for(byte c = frameCommandCount; c-- > 0;){
+        byte replaced = deviceStateSets(frame[2 * c + 1]);
+
+        if(replaced && (replaced & sets) == replaced){
+          frameCommandCount --;
+          memmove(&frame[2 * c + 1], &frame[2 * c + 3], 2 * (frameCommandCount - c));
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    // Add a command to the next frame.  Commands go out together when sendFrame() is called.
+    void queueCommand(byte pattern, byte option = I2C_NO_OPTION){
+      if(!commandPrepare(pattern, option)){ // Not in the command table, no Nano would know what to do with it
+        if(debugI2C){
+          Serial.print("Unknown I2C command: ");
+          Serial.println(pattern);
+        }
+        return;
+      }
+
+      DeviceState newState = queuedState;
+      if(!deviceStateApply(newState, pattern, option)){ // The lights are already that way
+        suppressedCommands ++;
+        if(debugI2C){
+          Serial.print("Suppressed I2C command ");
+          Serial.print(pattern);
+          Serial.print(" to ");
+          Serial.println(address);
+        }
+        return;
+      }
+
+      if(frameCommandCount == I2C_FRAME_MAX_COMMANDS && checkFree()){ // Frame is full, send what can go and make room
+        sendFrame();
+      }
+
+      if(frameCommandCount == I2C_FRAME_MAX_COMMANDS && !replaceCommand(pattern)){ // Still full while the device settles, and nothing waiting is made unneeded by it
+        status |= I2C_DEVICE_COMMAND_REFUSED;
+        if(debugI2C){
+          Serial.print("I2C frame full, command ");
+          Serial.print(pattern);
+          Serial.print(" to ");
+          Serial.print(address);
+          Serial.println(" refused");
+        }
+        return;
+      }
+
+      queuedState = newState;
+      frame[2 * frameCommandCount + 1] = pattern;
+      frame[2 * frameCommandCount + 2] = option;
+      frameCommandCount ++;
+    }
 
   public:
-    // Constructor
-    I2CDevice(byte address){
-      this->address = address;
+    // Constructor - device is its I2C_DEVICE_ position in the registry, which
+    // is also its timer number on both wheels
+    I2CDevice(byte device){
+      timer = device;
+      address = pgm_read_byte(&i2cDeviceAddresses[device]);
+      sleepTimers.start(timer, LIGHT_SLEEP_TICKS);
+      deviceStateForget(sentState);
+      deviceStateForget(queuedState);
     }
 
     // Methods
-    boolean checkPowerStatus(){
-      if(powerStatus){
-        return true;
-      } else {
+    void sendFrame(){
+      byte count = checkCommandCount();
+
+      if(count > 0){
+        byte out[I2C_FRAME_MAX_LENGTH];
+
+        memcpy(&out[1], &frame[1], 2 * count);
+        clearCommands(sendI2CFrame(address, out, i2cFrameFinish(out, count)));
+      }
+    }
+
+    byte checkAddress(){
+      return address;
+    }
+
+    // Commands that can go out in the next frame.  A frame ends at an RGB
+    // power on, the commands after it wait for the LEDs to settle.
+    byte checkCommandCount(){
+      for(byte c = 0; c < frameCommandCount; c++){
+        if(frame[2 * c + 1] == CMD_RGB_POWER_ON){
+          return c + 1;
+        }
+      }
+
+      return frameCommandCount;
+    }
+
+    // Check if the device can take a frame.  A device that is settling keeps
+    // its commands until it is ready, without holding up the other devices.
+    boolean checkReady(){
+      return !settleTimers.checkRunning(timer);
+    }
+
+    // Keep the waiting commands until every bar of the scene is ready
+    void holdForScene(){
+      status |= I2C_DEVICE_SCENE_HELD;
+    }
+
+    boolean checkSceneHeld(){
+      return status & I2C_DEVICE_SCENE_HELD;
+    }
+
+    // Check if a command has been refused since clearCommandRefused(), the
+    // caller has to queue it again once the frame has gone out
+    boolean checkCommandRefused(){
+      return status & I2C_DEVICE_COMMAND_REFUSED;
+    }
+
+    void clearCommandRefused(){
+      status &= ~I2C_DEVICE_COMMAND_REFUSED;
+    }
+
+    // Check if another device has the same commands ready to go out
+    boolean sameCommands(I2CDevice &other){
+      byte count = checkCommandCount();
+
+      if(count != other.checkCommandCount()){
         return false;
       }
+
+      return memcmp(&frame[1], &other.frame[1], 2 * count) == 0;
+    }
+
+    // Copy the commands ready to go out into another frame.  Returns the number of commands.
+    byte copyCommands(byte *destination){
+      byte count = checkCommandCount();
+
+      memcpy(destination, &frame[1], 2 * count);
+      return count;
+    }
+
+    // Forget the checkCommandCount() commands that just went out, the rest
+    // move up for the next frame.  If the frame was not acknowledged nothing
+    // is known about the lights any more, so the next command of every kind
+    // goes out.  A general call is acknowledged by any Nano that hears it, so
+    // after one, what its commands touch is unknown instead of known.
+    void clearCommands(boolean acknowledged, boolean generalCall = false){
+      byte count = checkCommandCount();
+
+      if(count == 0){
+        return;
+      }
+
+      if(!acknowledged){
+        deviceStateForget(sentState);
+        deviceStateForget(queuedState);
+      } else if(generalCall){
+        for(byte c = 0; c < count; c++){
+          deviceStateForgetCommand(sentState, frame[2 * c + 1]);
+        }
+      } else {
+        for(byte c = 0; c < count; c++){
+          deviceStateApply(sentState, frame[2 * c + 1], frame[2 * c + 2]);
+        }
+      }
+
+      if(frame[2 * count - 1] == CMD_RGB_POWER_ON){ // The LEDs are powering up, the commands after it wait for them
+        settleTimers.start(timer, RGB_POWER_SETTLE_TIME);
+      }
+
+      frameCommandCount -= count;
+      memmove(&frame[1], &frame[2 * count + 1], 2 * frameCommandCount);
+
+      if(acknowledged && generalCall){ // The commands still waiting go on from what is known now
+        queuedState = sentState;
+        for(byte c = 0; c < frameCommandCount; c++){
+          deviceStateApply(queuedState, frame[2 * c + 1], frame[2 * c + 2]);
+        }
+      }
+
+      if(frameCommandCount == 0){
+        status &= ~I2C_DEVICE_SCENE_HELD;
+      }
+    }
+
+    unsigned int checkSuppressedCommands(){
+      return suppressedCommands;
+    }
+
+    boolean checkPowerStatus(){
+      return status & I2C_DEVICE_POWERED;
     }
 
     void RGBLightBarPower(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,0);
-          powerStatus = false;
+          queueCommand(CMD_RGB_POWER_OFF);
+          status &= ~I2C_DEVICE_POWERED;
           break;
-        case 1: // ON
-          sendI2CMessage(address,1);
-          delay(60); // Give the light time to turn ON
-          powerStatus = true;
+        case 1: { // ON - the frame ends at the power on, the commands after it wait for the LEDs
+          byte waiting = frameCommandCount;
+
+          queueCommand(CMD_RGB_POWER_ON);
+          if(frameCommandCount > waiting && checkFree()){ // Otherwise sendI2CFrames() sends it once the device is free
+            sendFrame();
+          }
+          status |= I2C_DEVICE_POWERED;
           break;
+        }
       }
     }
 
     void checkLightActivity(){
-      /*if(checkPowerStatus() && !RGBLightsActive && !RGBLeftLightsActive && !RGBRightLightsActive && !RGBBrakeLightsActive && !mainLightsActive && !mainLeftLightsActive && !mainRightLightsActive && sleepTimer == 0){ // If all lights have just gone inactive, set the sleep timer
-        sleepTimer = millis();
-      }*/
-
-      if(RGBLightsActive || RGBLeftLightsActive || RGBRightLightsActive || RGBBrakeLightsActive || mainLightsActive || mainLeftLightsActive || mainRightLightsActive){ // If any of the lights go active, cancel the sleep timer
-        sleepTimer = millis();
+      if(activeLights){ // If any of the lights go active, restart the sleep timer
+        sleepTimers.start(timer, LIGHT_SLEEP_TICKS);
       }
 
-      if(checkPowerStatus() && millis() - sleepTimer >= LIGHT_SLEEP_TIME_INTERVAL){ // If the lights have been active for the specified time, shut them off.
+      if(checkPowerStatus() && sleepTimers.checkExpired(timer)){ // If the lights have been inactive for the specified time, shut them off.
         RGBLightBarPower(OFF);
       }
     }
 
     void allOff(){
-      sendI2CMessage(address,2);
-      RGBLightsActive = false;
-      RGBLeftLightsActive = false;
-      RGBRightLightsActive = false;
-      mainLightsActive = false;
-      mainLeftLightsActive = false;
-      mainRightLightsActive = false;
+      queueCommand(CMD_ALL_OFF);
+      activeLights &= ~(ACTIVE_RGB_ALL | ACTIVE_MAIN_ALL);
     }
 
     void allMainLights(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,3);
-          mainLightsActive = false;
-          mainLeftLightsActive = false;
-          mainRightLightsActive = false;
+          queueCommand(CMD_MAIN_OFF);
+          activeLights &= ~ACTIVE_MAIN_ALL;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,4);
-          mainLightsActive = true;
-          mainLeftLightsActive = true;
-          mainRightLightsActive = true;
+          queueCommand(CMD_MAIN_ON);
+          activeLights |= ACTIVE_MAIN_ALL;
           break;
       }
     }
@@ -248,16 +511,16 @@ class I2CDevice {
     void leftMainLights(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,5);
-          mainLeftLightsActive = false;
+          queueCommand(CMD_LEFT_MAIN_OFF);
+          activeLights &= ~ACTIVE_MAIN_LEFT;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,6);
-          mainLeftLightsActive = true;
+          queueCommand(CMD_LEFT_MAIN_ON);
+          activeLights |= ACTIVE_MAIN_LEFT;
           break;
       }
     }
@@ -265,16 +528,16 @@ class I2CDevice {
     void rightMainLights(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,7);
-          mainRightLightsActive = false;
+          queueCommand(CMD_RIGHT_MAIN_OFF);
+          activeLights &= ~ACTIVE_MAIN_RIGHT;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,8);
-          mainRightLightsActive = true;
+          queueCommand(CMD_RIGHT_MAIN_ON);
+          activeLights |= ACTIVE_MAIN_RIGHT;
           break;
       }
     }
@@ -282,10 +545,10 @@ class I2CDevice {
     void chaseLights(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,9);
+          queueCommand(CMD_CHASE_OFF);
           break;
         case 1: // ON
-          sendI2CMessage(address,10);
+          queueCommand(CMD_CHASE_ON);
           break;
       }
     }
@@ -293,20 +556,16 @@ class I2CDevice {
     void RGBAll(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,11);
-          RGBLightsActive = false;
-          RGBLeftLightsActive = false;
-          RGBRightLightsActive = false;
+          queueCommand(CMD_RGB_OFF);
+          activeLights &= ~ACTIVE_RGB_ALL;
           break;
         case 2: // RED
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,12);
-          RGBLightsActive = true;
-          RGBLeftLightsActive = true;
-          RGBRightLightsActive = true;
+          queueCommand(CMD_RGB_RED);
+          activeLights |= ACTIVE_RGB_ALL;
           break;
       }
     }
@@ -315,11 +574,11 @@ class I2CDevice {
       switch(var){
         case 2: // RED
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,13);
-          RGBLeftLightsActive = true;
+          queueCommand(CMD_RGB_LEFT_RED);
+          activeLights |= ACTIVE_RGB_LEFT;
           break;
       }
     }
@@ -328,11 +587,11 @@ class I2CDevice {
       switch(var){
         case 2: // RED
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,14);
-          RGBRightLightsActive = true;
+          queueCommand(CMD_RGB_RIGHT_RED);
+          activeLights |= ACTIVE_RGB_RIGHT;
           break;
       }
     }
@@ -340,16 +599,16 @@ class I2CDevice {
     void turnSignalLeft(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,15);
-          RGBLeftLightsActive = false;
+          queueCommand(CMD_TURN_LEFT_OFF);
+          activeLights &= ~ACTIVE_RGB_LEFT;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,16);
-          RGBLeftLightsActive = true;
+          queueCommand(CMD_TURN_LEFT_ON);
+          activeLights |= ACTIVE_RGB_LEFT;
           break;
       }
     }
@@ -357,16 +616,16 @@ class I2CDevice {
     void turnSignalRight(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,17);
-          RGBRightLightsActive = false;
+          queueCommand(CMD_TURN_RIGHT_OFF);
+          activeLights &= ~ACTIVE_RGB_RIGHT;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,18);
-          RGBRightLightsActive = true;
+          queueCommand(CMD_TURN_RIGHT_ON);
+          activeLights |= ACTIVE_RGB_RIGHT;
           break;
       }
     }
@@ -374,100 +633,121 @@ class I2CDevice {
     void brake(int var){
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,19);
-          RGBBrakeLightsActive = false;
+          queueCommand(CMD_BRAKE_OFF);
+          activeLights &= ~ACTIVE_RGB_BRAKE;
           break;
         case 1: // ON
           // Check if light has been powered on
-          if(!powerStatus){
+          if(!checkPowerStatus()){
             RGBLightBarPower(ON);
           }
-          sendI2CMessage(address,20);
-          RGBBrakeLightsActive = true;
+          queueCommand(CMD_BRAKE_ON);
+          activeLights |= ACTIVE_RGB_BRAKE;
           break;
       }
     }
 
     void RGBCautionPatternCycle(){
       // Check if light has been powered on
-      if(!powerStatus){
+      if(!checkPowerStatus()){
         RGBLightBarPower(ON);
       }
-      sendI2CMessage(address,21);
-      RGBLightsActive = true;
+      queueCommand(CMD_CAUTION_CYCLE);
+      activeLights |= ACTIVE_RGB;
     }
 
     void RGBHazard(int var){
       // Check if light has been powered on
-      if(!powerStatus){
+      if(!checkPowerStatus()){
         RGBLightBarPower(ON);
       }
       
       switch(var){
         case 0: // CENTER
-          sendI2CMessage(address,24);
+          queueCommand(CMD_HAZARD_CENTER);
           break;
         case 1: // LEFT
-          sendI2CMessage(address,22);
+          queueCommand(CMD_HAZARD_LEFT);
           break;
         case 2: // RIGHT
-          sendI2CMessage(address,23);
+          queueCommand(CMD_HAZARD_RIGHT);
           break;
       }
 
-      RGBLightsActive = true;
+      activeLights |= ACTIVE_RGB;
     }
 
     void RGBAllSolid(int var){
       
       // Check if light has been powered on
-      if(!powerStatus){
+      if(!checkPowerStatus()){
         RGBLightBarPower(ON);
       }
       
       switch(var){
         case 0: // OFF
-          sendI2CMessage(address,100,0);
-          RGBLightsActive = false;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_OFF);
+          activeLights &= ~ACTIVE_RGB;
           break;
         case 1: // WHITE
-          sendI2CMessage(address,100,1);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_WHITE);
+          activeLights |= ACTIVE_RGB;
           break;
         case 2: // RED
-          sendI2CMessage(address,100,2);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_RED);
+          activeLights |= ACTIVE_RGB;
           break;
         case 3: // GREEN
-          sendI2CMessage(address,100,3);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_GREEN);
+          activeLights |= ACTIVE_RGB;
           break;
         case 4: // BLUE
-          sendI2CMessage(address,100,4);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_BLUE);
+          activeLights |= ACTIVE_RGB;
           break;
         case 5: // ORANGE
-          sendI2CMessage(address,100,5);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_ORANGE);
+          activeLights |= ACTIVE_RGB;
           break;
         case 6: // YELLOW
-          sendI2CMessage(address,100,6);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_YELLOW);
+          activeLights |= ACTIVE_RGB;
           break;
         case 7: // PURPLE
-          sendI2CMessage(address,100,7);
-          RGBLightsActive = true;
+          queueCommand(CMD_RGB_SOLID, RGB_COLOR_PURPLE);
+          activeLights |= ACTIVE_RGB;
           break;
       }
     }
 
+    // Any command that sets every RGB light, with its option, as the scenes give them
+    void RGBPattern(byte pattern, byte option){
+      boolean lightsOn = pattern != CMD_RGB_OFF && !(pattern == CMD_RGB_SOLID && option == RGB_COLOR_OFF);
+
+      // Check if light has been powered on
+      if(lightsOn && !checkPowerStatus()){
+        RGBLightBarPower(ON);
+      }
+      queueCommand(pattern, option);
+
+      if(lightsOn){
+        activeLights |= ACTIVE_RGB;
+      } else {
+        activeLights &= ~ACTIVE_RGB_ALL;
+      }
+    }
+
+    void RGBBrightness(byte brightness){
+      queueCommand(CMD_RGB_BRIGHTNESS, brightness);
+    }
+
     void RGBRainbowRoad(){
       // Check if light has been powered on
-      if(!powerStatus){
+      if(!checkPowerStatus()){
         RGBLightBarPower(ON);
       }
-      sendI2CMessage(address,106,81);
-      RGBLightsActive = true;
+      queueCommand(CMD_RGB_RAINBOW, RAINBOW_FAST);
+      activeLights |= ACTIVE_RGB;
     }
 };
 
@@ -531,6 +811,104 @@ SwitchOnOff switchDriversMapLight;
 SwitchOnOffOn switchDomeLightSelect;
 SwitchOnOff switchPassengerMapLight;
 
+// Switch inputs - which shift register inputs put each switch in state 1 and
+// state 2, whether they are debounced as momentary inputs, and the handler
+// updateOutputs() runs when its state changes.  The table is in the order
+// updateOutputs() runs the handlers.
+#define NO_SWITCH_INPUT 255 // Two position switch, there is no state 2
+#define SWITCH_INPUT_MASK(input) ((input) == NO_SWITCH_INPUT ? 0UL : inputMask(input))
+
+typedef void (*SwitchHandler)();
+
+struct SwitchInput {
+  PanelSwitch *panelSwitch;
+  byte stateOneInput;
+  byte stateTwoInput;
+  uint32_t stateOneMask; // inputMask() of each input, so readInputs() does not shift at run time
+  uint32_t stateTwoMask;
+  boolean momentary;
+  SwitchHandler handler;
+};
+
+#define SWITCH_INPUT(panelSwitch, stateOneInput, stateTwoInput, handler) \
+  {&panelSwitch, stateOneInput, stateTwoInput, SWITCH_INPUT_MASK(stateOneInput), SWITCH_INPUT_MASK(stateTwoInput), false, handler}
+#define MOMENTARY_SWITCH_INPUT(panelSwitch, stateOneInput, stateTwoInput, handler) \
+  {&panelSwitch, stateOneInput, stateTwoInput, SWITCH_INPUT_MASK(stateOneInput), SWITCH_INPUT_MASK(stateTwoInput), true, handler}
+
+constexpr SwitchInput switchInputs[] PROGMEM = {
+  SWITCH_INPUT(switchOffRoadMode, 19, NO_SWITCH_INPUT, handleOffRoadMode),
+  SWITCH_INPUT(switchHazardMode, 18, NO_SWITCH_INPUT, handleHazardMode),
+  SWITCH_INPUT(switchObservatoryMode, 17, NO_SWITCH_INPUT, handleObservatoryMode),
+  SWITCH_INPUT(switchAllOnMode, 16, NO_SWITCH_INPUT, handleAllOnMode),
+  MOMENTARY_SWITCH_INPUT(switchMomentaryOffRoadModeSelect, 20, 21, handleOffRoadModeSelect),
+  SWITCH_INPUT(switchHazardModeSelect, 23, 22, handleHazardModeSelect),
+  SWITCH_INPUT(switchBumperLightBar, 0, 1, handleBumperLightBar),
+  SWITCH_INPUT(switchMainLightBar, 2, 3, handleMainLightBar),
+  SWITCH_INPUT(switchSideLightBars, 4, 5, handleSideLightBars),
+  SWITCH_INPUT(switchRearLightBar, 6, 7, handleRearLightBar),
+  SWITCH_INPUT(switchGMRSRadio, 8, 9, handleGMRSRadio),
+  SWITCH_INPUT(switchTunesRadio, 10, 11, handleTunesRadio),
+  SWITCH_INPUT(switchNightSignal, 12, 13, handleNightSignal),
+  MOMENTARY_SWITCH_INPUT(switchMomentarySideLightBars, 15, 14, handleMomentarySideLightBars),
+  SWITCH_INPUT(switchDriversMapLight, 27, NO_SWITCH_INPUT, handleDriversMapLight),
+  SWITCH_INPUT(switchDomeLightSelect, 25, 24, handleDomeLightSelect),
+  SWITCH_INPUT(switchPassengerMapLight, 26, NO_SWITCH_INPUT, handlePassengerMapLight)
+};
+
+#define SWITCH_COUNT (sizeof(switchInputs) / sizeof(switchInputs[0]))
+
+// Table positions, for switches other code needs to refer to
+#define SWITCH_OFF_ROAD_MODE 0
+#define SWITCH_HAZARD_MODE 1
+#define SWITCH_OBSERVATORY_MODE 2
+#define SWITCH_ALL_ON_MODE 3
+#define SWITCH_OFF_ROAD_MODE_SELECT 4
+#define SWITCH_HAZARD_MODE_SELECT 5
+#define SWITCH_BUMPER_LIGHT_BAR 6
+#define SWITCH_MAIN_LIGHT_BAR 7
+#define SWITCH_SIDE_LIGHT_BARS 8
+#define SWITCH_REAR_LIGHT_BAR 9
+#define SWITCH_GMRS_RADIO 10
+#define SWITCH_TUNES_RADIO 11
+#define SWITCH_NIGHT_SIGNAL 12
+#define SWITCH_MOMENTARY_SIDE_LIGHT_BARS 13
+#define SWITCH_DRIVERS_MAP_LIGHT 14
+#define SWITCH_DOME_LIGHT_SELECT 15
+#define SWITCH_PASSENGER_MAP_LIGHT 16
+
+#define SWITCH_EDGE(index) (1UL << (index))
+
+// Switches that feed each combined output
+#define MODE_SWITCH_EDGES (SWITCH_EDGE(SWITCH_OFF_ROAD_MODE) | SWITCH_EDGE(SWITCH_HAZARD_MODE) | SWITCH_EDGE(SWITCH_OBSERVATORY_MODE) | \
+                           SWITCH_EDGE(SWITCH_ALL_ON_MODE) | SWITCH_EDGE(SWITCH_OFF_ROAD_MODE_SELECT) | SWITCH_EDGE(SWITCH_HAZARD_MODE_SELECT) | \
+                           SWITCH_EDGE(SWITCH_NIGHT_SIGNAL))
+#define SIDE_LIGHT_SWITCH_EDGES (SWITCH_EDGE(SWITCH_ALL_ON_MODE) | SWITCH_EDGE(SWITCH_SIDE_LIGHT_BARS) | SWITCH_EDGE(SWITCH_MOMENTARY_SIDE_LIGHT_BARS))
+#define AREA_LIGHT_SWITCH_EDGES (SWITCH_EDGE(SWITCH_DRIVERS_MAP_LIGHT) | SWITCH_EDGE(SWITCH_DOME_LIGHT_SELECT) | SWITCH_EDGE(SWITCH_PASSENGER_MAP_LIGHT))
+#define OUTPUT_SHIFT_SWITCH_EDGES (SWITCH_EDGE(SWITCH_GMRS_RADIO) | SWITCH_EDGE(SWITCH_TUNES_RADIO) | SWITCH_EDGE(SWITCH_NIGHT_SIGNAL))
+#define HUD_INDICATOR_SWITCH_EDGES (SWITCH_EDGE(SWITCH_BUMPER_LIGHT_BAR) | SWITCH_EDGE(SWITCH_MAIN_LIGHT_BAR) | SWITCH_EDGE(SWITCH_SIDE_LIGHT_BARS) | \
+                                    SWITCH_EDGE(SWITCH_REAR_LIGHT_BAR) | SWITCH_EDGE(SWITCH_GMRS_RADIO) | SWITCH_EDGE(SWITCH_TUNES_RADIO) | \
+                                    SWITCH_EDGE(SWITCH_NIGHT_SIGNAL))
+
+constexpr boolean switchAt(byte index, const PanelSwitch *panelSwitch){
+  return switchInputs[index].panelSwitch == panelSwitch;
+}
+
+static_assert(switchAt(SWITCH_OFF_ROAD_MODE, &switchOffRoadMode) && switchAt(SWITCH_HAZARD_MODE, &switchHazardMode) &&
+              switchAt(SWITCH_OBSERVATORY_MODE, &switchObservatoryMode) && switchAt(SWITCH_ALL_ON_MODE, &switchAllOnMode) &&
+              switchAt(SWITCH_OFF_ROAD_MODE_SELECT, &switchMomentaryOffRoadModeSelect) &&
+              switchAt(SWITCH_HAZARD_MODE_SELECT, &switchHazardModeSelect) && switchAt(SWITCH_BUMPER_LIGHT_BAR, &switchBumperLightBar) &&
+              switchAt(SWITCH_MAIN_LIGHT_BAR, &switchMainLightBar) && switchAt(SWITCH_SIDE_LIGHT_BARS, &switchSideLightBars) &&
+              switchAt(SWITCH_REAR_LIGHT_BAR, &switchRearLightBar) && switchAt(SWITCH_GMRS_RADIO, &switchGMRSRadio) &&
+              switchAt(SWITCH_TUNES_RADIO, &switchTunesRadio) && switchAt(SWITCH_NIGHT_SIGNAL, &switchNightSignal) &&
+              switchAt(SWITCH_MOMENTARY_SIDE_LIGHT_BARS, &switchMomentarySideLightBars) &&
+              switchAt(SWITCH_DRIVERS_MAP_LIGHT, &switchDriversMapLight) && switchAt(SWITCH_DOME_LIGHT_SELECT, &switchDomeLightSelect) &&
+              switchAt(SWITCH_PASSENGER_MAP_LIGHT, &switchPassengerMapLight),
+              "A SWITCH_ position does not match the switchInputs table");
+
+static_assert(SWITCH_COUNT <= 32, "switchEdges has one bit per switch, there are more than 32 switches");
+
+uint32_t switchEdges = 0; // SWITCH_EDGE() of every switch whose handler is waiting to run
+
 // Lights
 InteriorLight indicatorBumperLightBar(0,0,1);// Strip ID | First LED Address | # of associated LEDs
 InteriorLight indicatorMainLightBar(0,1,1);
@@ -550,10 +928,124 @@ InteriorLight areaLightPassengerMap(0,27,4);
 //RelayControledDevice lightMainBar(52,0); // Relay 0: Pin number | Signal type 0=low signal activation, 1=high signal activation
 
 
-// I2C Devices
-I2CDevice mainLightBar(8);
-I2CDevice rearLightBar(9);
-I2CDevice sideLightBars(10);
+// I2C Devices, one per entry in the i2cDeviceAddresses registry and in the same order
+I2CDevice i2cDevices[] = {
+  I2CDevice(I2C_DEVICE_MAIN_BAR),
+  I2CDevice(I2C_DEVICE_REAR_BAR),
+  I2CDevice(I2C_DEVICE_SIDE_BARS)
+};
+
+static_assert(sizeof(i2cDevices) / sizeof(i2cDevices[0]) == I2C_DEVICE_COUNT, "i2cDevices needs one device per i2cDeviceAddresses entry");
+
+I2CDevice &mainLightBar = i2cDevices[I2C_DEVICE_MAIN_BAR];
+I2CDevice &rearLightBar = i2cDevices[I2C_DEVICE_REAR_BAR];
+I2CDevice &sideLightBars = i2cDevices[I2C_DEVICE_SIDE_BARS];
+
+// Scenes - what the RGB lights and chase lights of every bar show, as data.
+// Off Road, Hazard, Observatory and All On all want the RGB lights of the
+// bars.  Each mode has a row in modeScenes, highest priority first, naming
+// the scene it shows and what picks between its scenes.  updateModeLayers()
+// takes the first active mode's scene for the RGB lights, and turns the chase
+// lights on if any active mode's scene has them, then queues each bar the
+// whole scene.  The device's state mirror drops what the bar is already
+// showing, so only what differs goes out.  Turning a mode off drops the bars
+// back to the next active mode under it instead of to off.
+//
+// The bars of a scene are held until none of them is settling from a power
+// on, so they all get their commands in one general call frame and change on
+// the same frame, see sendI2CFrames().  A new scene is a new row in scenes.
+#define RGB_BAR_MAIN  0
+#define RGB_BAR_REAR  1
+#define RGB_BAR_SIDE  2
+#define RGB_BAR_COUNT 3
+
+#define SCENE_CHASE         0x01 // Chase lights on
+#define SCENE_CHASE_DAYTIME 0x02 // Chase lights on while the night signal is off
+
+#define SCENE_FULL_BRIGHTNESS 255 // What the Nano profiles start the bars at
+#define SCENE_DIM_BRIGHTNESS 16
+
+struct BarScene {
+  byte pattern;    // Command that sets every RGB light: CMD_RGB_OFF, CMD_CAUTION_CYCLE, CMD_HAZARD_, CMD_RGB_SOLID or CMD_RGB_RAINBOW
+  byte option;     // Its option: RGB_COLOR_, RAINBOW_ speed or I2C_NO_OPTION
+  byte brightness; // RGB brightness, 0 - 255
+  byte relays;     // SCENE_CHASE bits
+};
+
+struct Scene {
+  BarScene bars[RGB_BAR_COUNT]; // In RGB_BAR_ order
+};
+
+#define SCENE_BAR(pattern, option, brightness, relays) {pattern, option, brightness, relays}
+#define SCENE_BAR_OFF SCENE_BAR(CMD_RGB_OFF, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, 0)
+#define SCENE_BAR_CAUTION SCENE_BAR(CMD_CAUTION_CYCLE, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, 0)
+
+const Scene scenes[] PROGMEM = {
+  // SCENE_OFF
+  {{SCENE_BAR_OFF, SCENE_BAR_OFF, SCENE_BAR_OFF}},
+  // SCENE_CAUTION - Off Road caution pattern cycle, chase lights in the daytime
+  {{SCENE_BAR_CAUTION, SCENE_BAR_CAUTION,
+    SCENE_BAR(CMD_CAUTION_CYCLE, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, SCENE_CHASE_DAYTIME)}},
+  // SCENE_RAINBOW_ROAD - Off Road rainbow road, chase lights in the daytime
+  {{SCENE_BAR(CMD_RGB_RAINBOW, RAINBOW_FAST, SCENE_FULL_BRIGHTNESS, 0),
+    SCENE_BAR(CMD_RGB_RAINBOW, RAINBOW_FAST, SCENE_FULL_BRIGHTNESS, 0),
+    SCENE_BAR(CMD_RGB_RAINBOW, RAINBOW_FAST, SCENE_FULL_BRIGHTNESS, SCENE_CHASE_DAYTIME)}},
+  // SCENE_HAZARD_CENTER, SCENE_HAZARD_LEFT and SCENE_HAZARD_RIGHT - hazard on the rear bar, caution on the others
+  {{SCENE_BAR_CAUTION, SCENE_BAR(CMD_HAZARD_CENTER, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, 0), SCENE_BAR_CAUTION}},
+  {{SCENE_BAR_CAUTION, SCENE_BAR(CMD_HAZARD_LEFT, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, 0), SCENE_BAR_CAUTION}},
+  {{SCENE_BAR_CAUTION, SCENE_BAR(CMD_HAZARD_RIGHT, I2C_NO_OPTION, SCENE_FULL_BRIGHTNESS, 0), SCENE_BAR_CAUTION}},
+  // SCENE_OBSERVATORY - dim red on every bar, so nobody loses their night vision
+  {{SCENE_BAR(CMD_RGB_SOLID, RGB_COLOR_RED, SCENE_DIM_BRIGHTNESS, 0),
+    SCENE_BAR(CMD_RGB_SOLID, RGB_COLOR_RED, SCENE_DIM_BRIGHTNESS, 0),
+    SCENE_BAR(CMD_RGB_SOLID, RGB_COLOR_RED, SCENE_DIM_BRIGHTNESS, 0)}}
+};
+
+#define SCENE_COUNT (sizeof(scenes) / sizeof(scenes[0]))
+
+// Table positions
+#define SCENE_OFF 0
+#define SCENE_CAUTION 1
+#define SCENE_RAINBOW_ROAD 2
+#define SCENE_HAZARD_CENTER 3
+#define SCENE_HAZARD_LEFT 4
+#define SCENE_HAZARD_RIGHT 5
+#define SCENE_OBSERVATORY 6
+#define SCENE_NONE 255 // modeScene() of a mode that is off
+
+// What picks between a mode's scenes - the number it gives is added to the mode's first scene
+#define SCENE_SELECT_NONE 0
+#define SCENE_SELECT_HAZARD_DIRECTION 1 // Hazard Mode Select switch, CENTER LEFT RIGHT
+#define SCENE_SELECT_OFF_ROAD_PATTERN 2 // currentOffRoadPattern, CONSTRUCTION_PATTERN_CYCLE RAINBOW_ROAD
+
+struct ModeScene {
+  byte modeSwitch; // SWITCH_ position of the mode switch
+  byte scene;      // The mode's first scene
+  byte select;     // SCENE_SELECT_
+};
+
+// Highest priority first.  All On has no scene yet.
+constexpr ModeScene modeScenes[] PROGMEM = {
+  {SWITCH_HAZARD_MODE, SCENE_HAZARD_CENTER, SCENE_SELECT_HAZARD_DIRECTION},
+  {SWITCH_OFF_ROAD_MODE, SCENE_CAUTION, SCENE_SELECT_OFF_ROAD_PATTERN},
+  {SWITCH_OBSERVATORY_MODE, SCENE_OBSERVATORY, SCENE_SELECT_NONE}
+};
+
+#define MODE_SCENE_COUNT (sizeof(modeScenes) / sizeof(modeScenes[0]))
+
+// Largest number each SCENE_SELECT_ can give
+constexpr byte sceneSelectLast(byte select){
+  return select == SCENE_SELECT_HAZARD_DIRECTION ? RIGHT :
+         select == SCENE_SELECT_OFF_ROAD_PATTERN ? RAINBOW_ROAD : 0;
+}
+
+constexpr boolean modeScenesValid(byte m = 0){
+  return m == MODE_SCENE_COUNT ||
+         (modeScenes[m].scene + sceneSelectLast(modeScenes[m].select) < SCENE_COUNT && modeScenesValid(m + 1));
+}
+
+static_assert(modeScenesValid(), "A mode picks a scene past the end of the scenes table");
+
+I2CDevice *const rgbBars[RGB_BAR_COUNT] = {&mainLightBar, &rearLightBar, &sideLightBars};
 
 
 // Define Connections to 74HC165N used inreadInputs()
@@ -562,22 +1054,143 @@ I2CDevice sideLightBars(10);
 #define DATA_IN_PIN   27 // Q7 pin 9
 #define CLK_IN_PIN    29 // CP pin 2
 
+#define INPUT_CHAIN_CHIPS 4 // 74HC165s in the chain, 8 inputs each
+
+InputChain<INPUT_CHAIN_CHIPS> inputChain(LOAD_PIN, CLK_ENAB_PIN, DATA_IN_PIN, CLK_IN_PIN);
+
 // Define Shift Register Variables/Constants
-#define NUM_SHIFT_INPUTS 32 // Number of individual inputs coming in from the shift registers
-boolean currentShiftInput[NUM_SHIFT_INPUTS]; // Array to hold the individual values of incoming shift register values | 0-7 = shift_0, 8-15 = shift_1, 16-23 = shift_2
-boolean lastShiftInput[NUM_SHIFT_INPUTS]; // Array to hold the previous values of incoming shift register values
-boolean shiftInputDebounce[NUM_SHIFT_INPUTS]; // Array to hold the number of times the new value of the
+#define MOMENTARY_DEBOUNCE_SAMPLES 3 // Samples in a row (about 1 ms apart) a momentary input has to hold a new value for
+#define TOGGLE_DEBOUNCE_SAMPLES 5 // Samples in a row every other input has to hold a new value for
+InputDebounce<inputChain.words> shiftInputDebounce(MOMENTARY_DEBOUNCE_SAMPLES, TOGGLE_DEBOUNCE_SAMPLES);
+InputSampler<INPUT_CHAIN_CHIPS> inputSampler(inputChain, shiftInputDebounce); // Reads and debounces the inputs from a timer interrupt
+uint32_t lastShiftInputs[inputChain.words] = {}; // Debounced inputs, packed as in CarduinoInputChain.h
+
+// Check the switch map against the chain: every switch has a state 1 input,
+// every input is on the chain and no input is wired to two states
+constexpr byte switchInputNumber(byte n){ // Both inputs of every switch in turn, state 1 first
+  return n % 2 ? switchInputs[n / 2].stateTwoInput : switchInputs[n / 2].stateOneInput;
+}
+
+constexpr boolean switchInputUsedFrom(byte input, byte n){
+  return n < SWITCH_COUNT * 2 && ((input != NO_SWITCH_INPUT && switchInputNumber(n) == input) || switchInputUsedFrom(input, n + 1));
+}
+
+constexpr boolean switchInputsUnique(byte n){
+  return n >= SWITCH_COUNT * 2 || (!switchInputUsedFrom(switchInputNumber(n), n + 1) && switchInputsUnique(n + 1));
+}
+
+constexpr boolean switchInputsOnChain(byte s){
+  return s >= SWITCH_COUNT || (switchInputs[s].stateOneInput < inputChain.inputs &&
+                               (switchInputs[s].stateTwoInput < inputChain.inputs || switchInputs[s].stateTwoInput == NO_SWITCH_INPUT) &&
+                               switchInputsOnChain(s + 1));
+}
+
+static_assert(switchInputsOnChain(0), "A switch input is missing or past the end of the input chain");
+static_assert(switchInputsUnique(0), "A shift register input is used by more than one switch state");
+
+// Define analog sensor connections, scanned by the ADC interrupt
+#define LIGHT_SENSOR_CHANNEL 0 // A0
+#define TEMP_SENSOR_CHANNEL  1 // A1
+
+// Sensor numbers for analogScanner.checkValue(), in the order of analogSensorChannels
+#define LIGHT_SENSOR 0
+#define TEMP_SENSOR  1
+#define ANALOG_SENSOR_COUNT 2
+
+const byte analogSensorChannels[ANALOG_SENSOR_COUNT] = {LIGHT_SENSOR_CHANNEL, TEMP_SENSOR_CHANNEL};
+AnalogScanner<ANALOG_SENSOR_COUNT> analogScanner(analogSensorChannels); // Filtered sensor readings, never waits on the ADC
+
+// Conditions the AUTO rules read, one bit each (see CarduinoAutoRules.h)
+#define AUTO_NIGHT      0x0001 // Light sensor
+#define AUTO_HEADLIGHTS 0x0002 // Car signals
+#define AUTO_HIGH_BEAMS 0x0004
+#define AUTO_REVERSE    0x0008
+#define AUTO_OFF_ROAD   0x0010 // Mode switches
+#define AUTO_HAZARD     0x0020
+
+// Car signals, on the spare inputs at the end of the chain
+#define HEADLIGHTS_INPUT 28
+#define HIGH_BEAMS_INPUT 29
+#define REVERSE_INPUT    30
+
+// Chain inputs that set a condition - the car signals and the mode switches
+struct AutoInput {
+  byte input;
+  uint32_t mask; // inputMask() of the input
+  uint16_t condition;
+};
+
+#define AUTO_INPUT(input, condition) {input, inputMask(input), condition}
+
+constexpr AutoInput autoInputs[] PROGMEM = {
+  AUTO_INPUT(HEADLIGHTS_INPUT, AUTO_HEADLIGHTS),
+  AUTO_INPUT(HIGH_BEAMS_INPUT, AUTO_HIGH_BEAMS),
+  AUTO_INPUT(REVERSE_INPUT, AUTO_REVERSE),
+  AUTO_INPUT(switchInputs[SWITCH_OFF_ROAD_MODE].stateOneInput, AUTO_OFF_ROAD),
+  AUTO_INPUT(switchInputs[SWITCH_HAZARD_MODE].stateOneInput, AUTO_HAZARD)
+};
+
+#define AUTO_INPUT_COUNT (sizeof(autoInputs) / sizeof(autoInputs[0]))
+
+static_assert(HEADLIGHTS_INPUT < inputChain.inputs && HIGH_BEAMS_INPUT < inputChain.inputs && REVERSE_INPUT < inputChain.inputs,
+              "A car signal input is past the end of the input chain");
+static_assert(!switchInputUsedFrom(HEADLIGHTS_INPUT, 0) && !switchInputUsedFrom(HIGH_BEAMS_INPUT, 0) && !switchInputUsedFrom(REVERSE_INPUT, 0),
+              "A car signal input is also used by a switch");
+
+// Sensor readings that set a condition
+#define NIGHT_LIGHT_LEVEL (100 * ANALOG_VALUE_SCALE) // Light sensor reading it is night at, falling
+#define DAY_LIGHT_LEVEL   (150 * ANALOG_VALUE_SCALE) // and day again at, rising
+
+constexpr AutoThreshold autoThresholds[] PROGMEM = {
+  {LIGHT_SENSOR, AUTO_NIGHT, NIGHT_LIGHT_LEVEL, DAY_LIGHT_LEVEL}
+};
+
+#define AUTO_THRESHOLD_COUNT (sizeof(autoThresholds) / sizeof(autoThresholds[0]))
+
+// What each switch does in AUTO.  A switch with no rules stays off.  The
+// Side Light Bars have no auto configuration yet, and the bumper bar has no
+// controller to act on its decision yet.
+constexpr AutoRule autoRules[] PROGMEM = {
+  AUTO_RULE(SWITCH_BUMPER_LIGHT_BAR, AUTO_NIGHT | AUTO_HIGH_BEAMS, 0),
+  AUTO_RULE(SWITCH_BUMPER_LIGHT_BAR, AUTO_OFF_ROAD | AUTO_HIGH_BEAMS, 0),
+  AUTO_RULE(SWITCH_MAIN_LIGHT_BAR, AUTO_OFF_ROAD | AUTO_HIGH_BEAMS, 0),
+  AUTO_RULE(SWITCH_REAR_LIGHT_BAR, AUTO_NIGHT | AUTO_REVERSE, 0),
+  AUTO_RULE(SWITCH_NIGHT_SIGNAL, AUTO_NIGHT, 0),
+  AUTO_RULE(SWITCH_NIGHT_SIGNAL, AUTO_HEADLIGHTS, 0)
+};
+
+#define AUTO_RULE_COUNT (sizeof(autoRules) / sizeof(autoRules[0]))
+
+uint16_t autoConditions = 0; // AUTO_ conditions that are on
+AutoRuleEngine<AUTO_RULE_COUNT> autoRuleEngine(autoRules);
 
 // Define connections to 74HC595 - 5v Output Shift Registers
 #define LATCH_PIN     35 // RCLK  pin 12
 #define CLOCK_PIN     37 // SRCLK pin 11
 #define DATA_PIN      33 // SER   pin 14
 
+// Loop tasks - milliseconds between runs, and how late a run can start before it counts as a deadline miss
+#define INPUT_TASK_PERIOD    1    // Take the debounced switch changes, the sampler makes one a millisecond at most
+#define INPUT_TASK_DEADLINE  2
+#define SENSOR_TASK_PERIOD   100  // Sensor thresholds for the AUTO rules
+#define SENSOR_TASK_DEADLINE 100
+#define LOGIC_TASK_PERIOD    1    // Run the switch handlers
+#define LOGIC_TASK_DEADLINE  2
+#define POWER_TASK_PERIOD    1000 // Light bar sleep timers, minutes long
+#define POWER_TASK_DEADLINE  1000
+#define I2C_TASK_PERIOD      1    // Send the waiting frames, the time sync and the message LED
+#define I2C_TASK_DEADLINE    2
+#define HUD_TASK_PERIOD      10   // Show the HUD if it changed
+#define HUD_TASK_DEADLINE    10
+#define TASK_REPORT_PERIOD   10000
+#define LOOP_TASK_COUNT 7
+TaskScheduler<LOOP_TASK_COUNT> loopTasks;
+
 // Define 5v Output Shift Register variables/constants
 byte Shift_0Last = 0; // Hold the last value of the shift register to determine when to run the update code
 
 // Define Toggle Switch Variables/Constants
-boolean InputUpdated = false; // Latch to skip updateOutputs()
+boolean allOnDecision = false; // All On mode forces the lights on, disabled until new wiring is installed
 
 //Define calculations variables/constants
 byte sideLightDecisionPreviousState = OFF; // latch to keep the side light decision from running repeatedly
@@ -586,7 +1199,7 @@ byte sideLightDecisionPreviousState = OFF; // latch to keep the side light decis
 void setup() {
 
   // Start serial monitor if Debug is set to true
-  if (debugSwitches || debugI2C ) {
+  if (debugSwitches || debugI2C || debugTasks) {
     Serial.begin(115200);
   }
 
@@ -601,10 +1214,23 @@ void setup() {
   i2c_message_LED_status = 0;
 
   // Setup Input Shift Register connections (74HC165)
-  pinMode(LOAD_PIN, OUTPUT);
-  pinMode(CLK_ENAB_PIN, OUTPUT);
-  pinMode(CLK_IN_PIN, OUTPUT);
-  pinMode(DATA_IN_PIN, INPUT);
+  for(byte s = 0; s < SWITCH_COUNT; s++){
+    if(pgm_read_byte(&switchInputs[s].momentary)){
+      byte stateTwoInput = pgm_read_byte(&switchInputs[s].stateTwoInput);
+
+      shiftInputDebounce.setMomentary(pgm_read_byte(&switchInputs[s].stateOneInput));
+      if(stateTwoInput != NO_SWITCH_INPUT){
+        shiftInputDebounce.setMomentary(stateTwoInput);
+      }
+    }
+  }
+  inputSampler.begin();
+
+  // Start scanning the analog sensors
+  analogScanner.begin();
+
+  // Work out the AUTO decisions for no conditions, the inputs and sensors set theirs as they come in
+  autoRuleEngine.begin();
 
   // Setup 5v Output Shift Registers connections (74HC595)
   pinMode(LATCH_PIN, OUTPUT);
@@ -619,16 +1245,10 @@ void setup() {
   shiftOut(DATA_PIN, CLOCK_PIN, LSBFIRST, 0); // Shift out the data
   digitalWrite(LATCH_PIN, HIGH); // Bring RCLK HIGH to change outputs
 
-  // Fill arrays with starting values
-  for(size_t cv = 0; cv < NUM_SHIFT_INPUTS; cv++){
-    lastShiftInput[cv] = false;
-    shiftInputDebounce[cv] = false;
-
   // Initialize Neopixels
   overheadControlsStrip.setBrightness(HUDbrightness);
   overheadControlsStrip.begin();
   overheadControlsStrip.show(); // Initialize all pixels to 'off'
-  }
 
   // Fill the HUD with the initial color.
   indicatorBumperLightBar.updateColor(hudColor);
@@ -640,16 +1260,88 @@ void setup() {
   indicatorNightSignal.updateColor(hudColor);
 
   delay(1000); // Give other arduinos time to startup. This solves an issue where if a switch is in a non OFF state when the project is started the lights wont update.  !!!FIX ME!!!
+
+  // Loop tasks, in the order each pass runs them: switch changes reach the I2C
+  // frames in the same pass, and the HUD shows the result right after
+  loopTasks.addTask("Inputs", readInputs, INPUT_TASK_PERIOD, INPUT_TASK_DEADLINE);
+  loopTasks.addTask("Sensors", taskSensors, SENSOR_TASK_PERIOD, SENSOR_TASK_DEADLINE);
+  loopTasks.addTask("Logic", taskLogic, LOGIC_TASK_PERIOD, LOGIC_TASK_DEADLINE);
+  loopTasks.addTask("Power", taskPower, POWER_TASK_PERIOD, POWER_TASK_DEADLINE);
+  loopTasks.addTask("I2C", taskI2C, I2C_TASK_PERIOD, I2C_TASK_DEADLINE);
+  loopTasks.addTask("HUD", taskHUD, HUD_TASK_PERIOD, HUD_TASK_DEADLINE);
+  loopTasks.addTask("Report", taskReport, TASK_REPORT_PERIOD, TASK_REPORT_PERIOD);
+  settleTimers.begin(millis());
+  sleepTimers.begin(millis());
+  loopTasks.begin();
 }
 
 
 void loop() {
+  loopTasks.run();
+}
+
+
+// Functions
+
+// Loop tasks
+
+// Switch handlers and the outputs they feed, when a switch or an AUTO decision changed
+void taskLogic(){
+  settleTimers.tick(millis());
+
+  updateAutoRules();
+
+  if(modeLayersPending){ // A scene did not fit in a bar's frame last time
+    updateModeLayers();
+  }
 
-  readInputs();
-  if(InputUpdated){
+  // A new night signal changes the HUD base color, calculations() marks every indicator to be repainted
+  if(switchEdges & SWITCH_EDGE(SWITCH_NIGHT_SIGNAL)){
     calculations();
+  }
+
+  if(switchEdges){
     updateOutputs();
   }
+}
+
+// Sensor thresholds the AUTO rules read
+void taskSensors(){
+  for(byte t = 0; t < AUTO_THRESHOLD_COUNT; t++){
+    byte sensor = pgm_read_byte(&autoThresholds[t].sensor);
+    uint16_t condition = pgm_read_word(&autoThresholds[t].condition);
+
+    if(analogScanner.checkUpdates(sensor) == 0){ // No reading yet
+      continue;
+    }
+
+    if(autoThresholdState(pgm_read_word(&autoThresholds[t].onLevel), pgm_read_word(&autoThresholds[t].offLevel),
+                          analogScanner.checkValue(sensor), autoConditions & condition)){
+      autoConditions |= condition;
+    } else {
+      autoConditions &= ~condition;
+    }
+  }
+}
+
+// Check if light bars need to be powered off due to inactivity
+void taskPower(){
+  sleepTimers.tick(millis());
+
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    if(i2cDevices[d].checkPowerStatus()){
+      i2cDevices[d].checkLightActivity();
+    }
+  }
+}
+
+void taskI2C(){
+  sendI2CFrames(); // Everything since the last pass goes out as one frame per device
+
+  // Keep the Nanos' clocks in step
+  if((millis() - i2c_sync_timer) >= I2C_SYNC_INTERVAL){
+    sendTimeSync();
+  }
 
   // Turn off I2C Message LED once the timer has expired
   if((millis() - i2c_message_LED_flash_start_timer) > I2C_MESSAGE_RECEIVED_LED_FLASH_LENGTH){
@@ -660,30 +1352,27 @@ void loop() {
   if(i2c_active){
     digitalWrite(13, i2c_message_LED_status);
   }
+}
 
-  // activate all changes to LEDs
-  overheadControlsStrip.show();
-
-  // Check if light bars need to be powered off due to inactivity
-  if(mainLightBar.checkPowerStatus()){
-    mainLightBar.checkLightActivity();
-  }
-
-  if(rearLightBar.checkPowerStatus()){
-    rearLightBar.checkLightActivity();
+// activate all changes to LEDs
+void taskHUD(){
+  if(hudChanged){
+    overheadControlsStrip.show();
+    hudChanged = false;
   }
+}
 
-  if(sideLightBars.checkPowerStatus()){
-    sideLightBars.checkLightActivity();
+void taskReport(){
+  if(debugTasks){
+    loopTasks.report(Serial);
   }
 }
 
-
-// Functions
-
 void readInputs(){
 
-  byte shift_0, shift_1, shift_2, shift_3; // Variables to hold incoming binary data
+  InputSampler<INPUT_CHAIN_CHIPS>::Event inputEvent; // Debounced change from the input sampler
+  uint32_t changedShiftInputs[inputChain.words] = {}; // Inputs that changed since the last pass
+  boolean inputsChanged = false;
 
   /*
    * ---INPUT LIST---
@@ -698,206 +1387,96 @@ void readInputs(){
    * Side Light Bars Momentary    LEFT (shift_1, 6) | OFF | RIGHT (shift_1, 7)
    */
 
-  // Write pulse to load pin
-  digitalWrite(LOAD_PIN, LOW);
-  delayMicroseconds(5);
-  digitalWrite(LOAD_PIN, HIGH);
-  delayMicroseconds(5);
-
-  // Get data from 74HC165
-  digitalWrite(CLK_IN_PIN, HIGH);
-  digitalWrite(CLK_ENAB_PIN, LOW);
-  shift_0 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
-  shift_1 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
-  shift_2 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
-  shift_3 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
-  digitalWrite(CLK_ENAB_PIN, HIGH);
-
-  // Move shift data into an array
-  for(size_t cv = 0; cv < NUM_SHIFT_INPUTS; cv++){
-    if(cv >= 0 and cv <= 7){
-      currentShiftInput[cv] = bitRead(shift_0, cv);
-    } else if(cv >= 8 and cv <= 15){
-      currentShiftInput[cv] = bitRead(shift_1, (cv - 8));
-    } else if(cv >= 16 and cv <= 23){
-      currentShiftInput[cv] = bitRead(shift_2, (cv - 16));
-    } else if(cv >= 24 and cv <= 31){
-      currentShiftInput[cv] = bitRead(shift_3, (cv - 24));
+  // Take the changes the input sampler has debounced since the last pass
+  while(inputSampler.nextEvent(inputEvent)){
+    for(byte word = 0; word < inputChain.words; word++){
+      changedShiftInputs[word] |= inputEvent.changed[word];
+      lastShiftInputs[word] = inputEvent.state[word];
     }
-  }
+    inputsChanged = true;
 
-  // Check if any inputs have changed since last pass
-  for(size_t cv = 0; cv < NUM_SHIFT_INPUTS; cv++){
-    if(currentShiftInput[cv] != lastShiftInput[cv]){
-      // Check if we have debounced the input
-      if(shiftInputDebounce[cv] == false){
-        shiftInputDebounce[cv] = true;
-      } else if(shiftInputDebounce[cv] == true){
-        lastShiftInput[cv] = currentShiftInput[cv];
-        shiftInputDebounce[cv] = false;
-        InputUpdated = true; // Turn on flag to allow UpdateOutputs() to run
+    if(debugSwitches){
+      Serial.print("Inputs changed:");
+      for(byte word = inputChain.words; word > 0; word--){
+        Serial.print(" ");
+        Serial.print(inputEvent.changed[word - 1], HEX);
       }
-    } else {
-      shiftInputDebounce[cv] = false; // If debounce was started in error, reset the debounce flag.
+      Serial.print(" waited ");
+      Serial.print(millis() - inputEvent.time);
+      Serial.println(" ms");
     }
   }
 
-  // Update the switch objects based on the new input data
-
-  // Bumper Bar
-  if(lastShiftInput[0]){
-    switchBumperLightBar.updateCurrentState(1);
-  } else if(lastShiftInput[1]){
-    switchBumperLightBar.updateCurrentState(2);
-  } else {
-    switchBumperLightBar.updateCurrentState(0);
-  }
-
-  // Main Light Bar
-  if(lastShiftInput[2]){
-    switchMainLightBar.updateCurrentState(1);
-  } else if(lastShiftInput[3]){
-    switchMainLightBar.updateCurrentState(2);
-  } else {
-    switchMainLightBar.updateCurrentState(0);
+  if(!inputsChanged){
+    return;
   }
 
-  // Side Light Bars
-  if(lastShiftInput[4]){
-    switchSideLightBars.updateCurrentState(1);
-  } else if(lastShiftInput[5]){
-    switchSideLightBars.updateCurrentState(2);
-  } else {
-    switchSideLightBars.updateCurrentState(0);
-  }
-
-  // Rear Light Bar
-  if(lastShiftInput[6]){
-    switchRearLightBar.updateCurrentState(1);
-  } else if(lastShiftInput[7]){
-    switchRearLightBar.updateCurrentState(2);
-  } else {
-    switchRearLightBar.updateCurrentState(0);
-  }
-
-  // GMRS Radio
-  if(lastShiftInput[8]){
-    switchGMRSRadio.updateCurrentState(1);
-  } else if(lastShiftInput[9]){
-    switchGMRSRadio.updateCurrentState(2);
-  } else {
-    switchGMRSRadio.updateCurrentState(0);
-  }
-
-  // Tunes Radio
-  if(lastShiftInput[10]){
-    switchTunesRadio.updateCurrentState(1);
-  } else if(lastShiftInput[11]){
-    switchTunesRadio.updateCurrentState(2);
-  } else {
-    switchTunesRadio.updateCurrentState(0);
-  }
-
-  // Night Signal
-  if(lastShiftInput[12]){
-    switchNightSignal.updateCurrentState(1);
-  } else if(lastShiftInput[13]){
-    switchNightSignal.updateCurrentState(2);
-  } else {
-    switchNightSignal.updateCurrentState(0);
-  }
-
-  // Side Light Bars Momentary
-  if(lastShiftInput[14]){
-    switchMomentarySideLightBars.updateCurrentState(2);
-  } else if(lastShiftInput[15]){
-    switchMomentarySideLightBars.updateCurrentState(1);
-  } else {
-    switchMomentarySideLightBars.updateCurrentState(0);
-  }
-
-  // Offroad Mode
-  if(lastShiftInput[19]){
-    switchOffRoadMode.updateCurrentState(1);
-  } else {
-    switchOffRoadMode.updateCurrentState(0);
-  }
-
-  // Hazard Mode
-  if(lastShiftInput[18]){
-    switchHazardMode.updateCurrentState(1);
-  } else {
-    switchHazardMode.updateCurrentState(0);
-  }
-
-  // Observatory Mode
-  if(lastShiftInput[17]){
-    switchObservatoryMode.updateCurrentState(1);
-  } else {
-    switchObservatoryMode.updateCurrentState(0);
-  }
+  // Decode only the switches whose inputs changed, and mark those whose state changed
+  for(byte s = 0; s < SWITCH_COUNT; s++){
+    byte stateOneWord = inputWord(pgm_read_byte(&switchInputs[s].stateOneInput));
+    uint32_t stateOneMask = pgm_read_dword(&switchInputs[s].stateOneMask);
+    uint32_t stateTwoMask = pgm_read_dword(&switchInputs[s].stateTwoMask);
+    byte stateTwoWord = stateTwoMask ? inputWord(pgm_read_byte(&switchInputs[s].stateTwoInput)) : stateOneWord;
+
+    if((changedShiftInputs[stateOneWord] & stateOneMask) || (changedShiftInputs[stateTwoWord] & stateTwoMask)){
+      PanelSwitch *panelSwitch = (PanelSwitch *)pgm_read_ptr(&switchInputs[s].panelSwitch);
+      byte newState = OFF;
+
+      if(lastShiftInputs[stateOneWord] & stateOneMask){
+        newState = 1;
+      } else if(lastShiftInputs[stateTwoWord] & stateTwoMask){
+        newState = 2;
+      }
 
-  // All on Mode
-  if(lastShiftInput[16]){
-    switchAllOnMode.updateCurrentState(1);
-  } else {
-    switchAllOnMode.updateCurrentState(0);
+      if(newState != panelSwitch->checkState()){
+        panelSwitch->updateCurrentState(newState);
+        switchEdges |= SWITCH_EDGE(s); // Let updateOutputs() run this switch's handler
+      }
+    }
   }
 
-  // Offroad Mode Light Pattern Select
-  if(lastShiftInput[20]){
-    switchMomentaryOffRoadModeSelect.updateCurrentState(1);
-  } else if(lastShiftInput[21]){
-    switchMomentaryOffRoadModeSelect.updateCurrentState(2);
-  } else {
-    switchMomentaryOffRoadModeSelect.updateCurrentState(0);
-  }
+  // Car signals and mode switches the AUTO rules read
+  for(byte a = 0; a < AUTO_INPUT_COUNT; a++){
+    byte word = inputWord(pgm_read_byte(&autoInputs[a].input));
+    uint32_t mask = pgm_read_dword(&autoInputs[a].mask);
 
-  // Hazard Mode Direction Choice
-  if(lastShiftInput[23]){
-    switchHazardModeSelect.updateCurrentState(1);
-  } else if(lastShiftInput[22]){
-    switchHazardModeSelect.updateCurrentState(2);
-  } else {
-    switchHazardModeSelect.updateCurrentState(0);
-  }
+    if(changedShiftInputs[word] & mask){
+      uint16_t condition = pgm_read_word(&autoInputs[a].condition);
 
-  // Drivers Side Map Light
-  if(lastShiftInput[27]){
-    switchDriversMapLight.updateCurrentState(1);
-  } else {
-    switchDriversMapLight.updateCurrentState(0);
+      if(lastShiftInputs[word] & mask){
+        autoConditions |= condition;
+      } else {
+        autoConditions &= ~condition;
+      }
+    }
   }
+}
 
-  // Dome Light Mode Select
-  if(lastShiftInput[25]){
-    switchDomeLightSelect.updateCurrentState(1);
-  } else if(lastShiftInput[24]){
-    switchDomeLightSelect.updateCurrentState(2);
-  } else {
-    switchDomeLightSelect.updateCurrentState(0);
-  }
+// Take in the AUTO conditions and run the handler of every switch in AUTO whose decision changed
+void updateAutoRules(){
+  uint32_t changedDecisions = autoRuleEngine.update(autoConditions);
 
-  // Passengers Side Map Light
-  if(lastShiftInput[26]){
-    switchPassengerMapLight.updateCurrentState(1);
-  } else {
-    switchPassengerMapLight.updateCurrentState(0);
+  for(byte s = 0; changedDecisions; s++, changedDecisions >>= 1){
+    if((changedDecisions & 1) && ((PanelSwitch *)pgm_read_ptr(&switchInputs[s].panelSwitch))->checkState() == AUTO){
+      switchEdges |= SWITCH_EDGE(s);
+    }
   }
+}
 
+// Night Signal is on, or in AUTO and the rules say it should be
+boolean nightSignalOn(){
+  return switchNightSignal.checkState() == ON || (switchNightSignal.checkState() == AUTO && autoRuleEngine.checkDecision(SWITCH_NIGHT_SIGNAL));
 }
 
 void calculations(){
   // Update the HUD base color
-  if(switchNightSignal.checkState() == ON){
+  if(nightSignalOn()){
     hudColor = red;
     HUDbrightness = 51; // Set brightness to 1/5
 
-  } else if(switchNightSignal.checkState() == OFF){
+  } else {
     hudColor = white;
     HUDbrightness = 255; // Set brightness to full
-  } else {
-    // Auto control at later date
   }
 
   // Set overheadControlsStrip brightness
@@ -910,29 +1489,16 @@ void calculations(){
   indicatorGMRSRadio.updateColor(hudColor);
   indicatorTunesRadio.updateColor(hudColor);
   indicatorNightSignal.updateColor(hudColor);
+
+  // Run every indicator's handler again so it paints its state over the new
+  // base color.  The Side Light Bars edge also runs updateSideLights().
+  switchEdges |= HUD_INDICATOR_SWITCH_EDGES;
 }
 
+// Run the handler of every switch whose state changed, then update the
+// outputs that more than one switch feeds into
 void updateOutputs(){
-  // Create Temporary Variables
-  boolean rightLightDecision = false; // Variable to evaluate turning on the right lights
-  boolean leftLightDecision = false; // Variable to evaluate turning on the left lights
-  boolean rearLightDecision = false; // Variable to evaluate turning on the Rear light
-  boolean driversSideMapLightDecision = false; // Variable to evaluate turning on the Drivers side map light
-  boolean passengersSideMapLightDecision = false; // Variable to evaluate turning on the Passengers side map light
-  boolean domeLightDecision = false; // Variable to evaluate turning on the dome light
-  boolean allOnDecision = false; // Variable to evaluate turning all lights on
-  byte Shift_0Current = 0; // Binary enumerated value to update the 5v Output Shift Registers
-  //boolean 595OutputUpdate = false; // Flag to activate 5v Output Shift Registers update code
-
-  /*
-  Shift Register Values
-  Output  Value   Name
-  1       128     GMRS Radio
-  2       64      Tunes Radio
-  3       32      Night Signal
-  */
-
-  // ---Human Inputs---
+  uint32_t handledEdges = 0;
 
   /*
    ---Indicator List---
@@ -945,130 +1511,80 @@ void updateOutputs(){
    Night Signal     LED 6
    */
 
-  // Update current brightness
-  overheadControlsStrip.setBrightness(HUDbrightness);
+  // A handler can mark another switch, such as a select switch re-running its mode, so keep going until none are left
+  while(switchEdges){
+    for(byte s = 0; s < SWITCH_COUNT; s++){
+      if(switchEdges & SWITCH_EDGE(s)){
+        switchEdges &= ~SWITCH_EDGE(s);
+        handledEdges |= SWITCH_EDGE(s);
+
+        SwitchHandler handler = (SwitchHandler)pgm_read_ptr(&switchInputs[s].handler);
+        handler();
+      }
+    }
+  }
+
+  // Print debug message
+  if (debugSwitches) {
+    Serial.println("----------------------------------------");
+  }
+
+  // ---Final evaluations---
+  if(handledEdges & MODE_SWITCH_EDGES){
+    updateModeLayers();
+  }
+
+  if(handledEdges & SIDE_LIGHT_SWITCH_EDGES){
+    updateSideLights();
+  }
 
-  // ----Mode Inputs----
+  if(handledEdges & AREA_LIGHT_SWITCH_EDGES){
+    updateAreaLights();
+  }
 
-  // Off Road Mode
+  if(handledEdges & OUTPUT_SHIFT_SWITCH_EDGES){
+    updateOutputShiftRegisters();
+  }
+}
+
+// Off Road Mode - the light bars are set in updateModeLayers()
+void handleOffRoadMode(){
   switch(switchOffRoadMode.checkState()) {
      case ON:
        // Print debug message
        if(debugSwitches) {
          Serial.println("Switch 08 - ON   - Off Road Mode");
        }
-
-       if((switchOffRoadMode.checkPreviousState() != switchOffRoadMode.checkState()) || offRoadPatternUpdated == true){ // Only run commands if the switch just changed state
-          
-          switch(currentOffRoadPattern){
-            case 0: // Construction pattern cycle
-              mainLightBar.RGBCautionPatternCycle();
-              rearLightBar.RGBCautionPatternCycle();
-              sideLightBars.RGBCautionPatternCycle();
-              break;
-            
-            case 1: // Rainbow Road
-              mainLightBar.RGBRainbowRoad();
-              rearLightBar.RGBRainbowRoad();
-              sideLightBars.RGBRainbowRoad();
-              break;
-          }
-
-          if(switchNightSignal.checkState() == OFF) { // Turn on Chase Lights if it's daytime
-            delay(30); // Leave time when sending a double signal
-            sideLightBars.chaseLights(ON);
-          }
-
-          offRoadPatternUpdated = false; // Clear flag telling Off Road Mode code to run again
-
-          switchOffRoadMode.updatePreviousState(); // Update previous state to only run once as needed
-       }
        break;
      case OFF:
-       // Print debug message
-       if(debugSwitches) {
-         Serial.println("Switch 08 - OFF  - Off Road Mode");
-       }
-
-       if(switchOffRoadMode.checkPreviousState() != switchOffRoadMode.checkState()){ // Only run commands if the switch just changed state
-          // Turn all RGB lights off
-          mainLightBar.RGBAll(OFF);
-          rearLightBar.RGBAll(OFF);
-          sideLightBars.RGBAll(OFF);
-
-          delay(30); // Leave time when sending a double signal
-          sideLightBars.chaseLights(OFF);
-
-          switchOffRoadMode.updatePreviousState(); // Update previous state to only run once as needed
+       // Print debug message
+       if(debugSwitches) {
+         Serial.println("Switch 08 - OFF  - Off Road Mode");
        }
        break;
    }
+}
 
-  // Hazard Mode
+// Hazard Mode - the light bars are set in updateModeLayers()
+void handleHazardMode(){
   switch (switchHazardMode.checkState()) {
     case ON:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 09 - ON   - Hazard Mode");
       }
-
-      // Run once code
-      if (switchHazardMode.checkPreviousState() != switchHazardMode.checkState() || hazardModeDirectionUpdated == true){ // Only run commands if the switch just changed state or Hazard Mode Direction selection has changed
-        
-        if(hazardModeDirectionUpdated == false){ // If this pass is due to a direction selection update, skip sending these messages
-          mainLightBar.RGBCautionPatternCycle();
-          sideLightBars.RGBCautionPatternCycle();
-        }
-
-        switch(switchHazardModeSelect.checkState()){
-          case LEFT:
-            rearLightBar.RGBHazard(LEFT);
-            break;
-
-          case CENTER:
-            rearLightBar.RGBHazard(CENTER);
-            break;
-
-          case RIGHT:
-            rearLightBar.RGBHazard(RIGHT);
-            break;
-        }
-
-        hazardModeDirectionUpdated = false;
-        
-        switchHazardMode.updatePreviousState(); // Update previous state to only run once as needed
-      }
-
-      // Run always code
-
-      // None currently
-      
       break;
     case OFF:
-    // Print debug message
-    if (debugSwitches) {
-      Serial.println("Switch 09 - OFF  - Hazard Mode");
-    }
-  
-    // Run once code
-    if (switchHazardMode.checkPreviousState() != switchHazardMode.checkState()){ // Only run commands if the switch just changed state
-      
-      // Turn all RGB lights off
-      mainLightBar.RGBAll(OFF);
-      rearLightBar.RGBAll(OFF);
-      sideLightBars.RGBAll(OFF);
-
-      switchHazardMode.updatePreviousState(); // Update previous state to only run once as needed
-    }
-
-    // Run always code
-    
-    // None so far
-
-    break;
+      // Print debug message
+      if (debugSwitches) {
+        Serial.println("Switch 09 - OFF  - Hazard Mode");
+      }
+      break;
   }
+}
 
-   // Observatory Mode
+// Observatory Mode - the light bars are set in updateModeLayers()
+void handleObservatoryMode(){
    switch (switchObservatoryMode.checkState()) {
      case ON:
        // Print debug message
@@ -1099,7 +1615,10 @@ void updateOutputs(){
 
        break;
     }
+}
 
+// All On Mode
+void handleAllOnMode(){
     // Disable all on mode until new wiring is installed and this mode is fixed.
     /*
     // All On Mode
@@ -1119,9 +1638,12 @@ void updateOutputs(){
         allOnDecision = false;
         break;
       }
+    switchEdges |= HUD_INDICATOR_SWITCH_EDGES; // Every light bar handler checks allOnDecision
     */
+}
 
-   // Offroad Mode Light Pattern Select
+// Offroad Mode Light Pattern Select
+void handleOffRoadModeSelect(){
    switch (switchMomentaryOffRoadModeSelect.checkState()) {
      case NEXT:
        // Print debug message
@@ -1137,8 +1659,6 @@ void updateOutputs(){
             currentOffRoadPattern = 0;
           }
 
-          offRoadPatternUpdated = true; // Tell Off Road Mode code to run again
-
           switchMomentaryOffRoadModeSelect.updatePreviousState(); // Update previous state to only run once as needed
        }
 
@@ -1171,71 +1691,39 @@ void updateOutputs(){
             currentOffRoadPattern --; // Decrement pattern
           }
 
-          offRoadPatternUpdated = true; // Tell Off Road Mode code to run again
-
           switchMomentaryOffRoadModeSelect.updatePreviousState(); // Update previous state to only run once as needed
        }
 
        break;
    }
+}
 
-   // Hazard Mode Direction Choice
+// Hazard Mode Direction Choice - the rear bar picks up the direction in updateModeLayers()
+void handleHazardModeSelect(){
    switch (switchHazardModeSelect.checkState()) {
      case LEFT:
        // Print debug message
        if (debugSwitches) {
          Serial.println("Switch 13 - LEFT - Hazard Mode Direction Choice");
        }
-       
-       if (switchHazardModeSelect.checkPreviousState() != switchHazardModeSelect.checkState()){ // Only run commands if the switch just changed state
-          
-          if(switchHazardMode.checkState() == ON){
-            hazardModeDirectionUpdated = true;
-          }
-          
-          switchHazardModeSelect.updatePreviousState(); // Update previous state to only run once as needed
-        }
-
        break;
      case CENTER:
        // Print debug message
        if (debugSwitches) {
          Serial.println("Switch 13 - CENT - Hazard Mode Direction Choice");
        }
-       
-       if (switchHazardModeSelect.checkPreviousState() != switchHazardModeSelect.checkState()){ // Only run commands if the switch just changed state
-          
-          if(switchHazardMode.checkState() == ON){
-            hazardModeDirectionUpdated = true;
-          }
-
-          switchHazardModeSelect.updatePreviousState(); // Update previous state to only run once as needed
-        }
-
        break;
      case RIGHT:
        // Print debug message
        if (debugSwitches) {
          Serial.println("Switch 13 - RIGT - Hazard Mode Direction Choice");
        }
-       
-       if (switchHazardModeSelect.checkPreviousState() != switchHazardModeSelect.checkState()){ // Only run commands if the switch just changed state
-          
-          if(switchHazardMode.checkState() == ON){
-            hazardModeDirectionUpdated = true;
-          }
-
-          switchHazardModeSelect.updatePreviousState(); // Update previous state to only run once as needed
-        }
-
        break;
     }
+}
 
-
-   // ----Device Inputs----
-
-
-  // Bumper Light Bar
+// Bumper Light Bar
+void handleBumperLightBar(){
   if(allOnDecision){ // Force light on if All On mode is active
     indicatorBumperLightBar.updateColor(green);
   } else {
@@ -1264,10 +1752,11 @@ void updateOutputs(){
 
         if (switchBumperLightBar.checkPreviousState() != switchBumperLightBar.checkState()){ // Only run commands if the switch just changed state
           
-          indicatorBumperLightBar.updateColor(hudColor); // Update hud indicator
-
           switchBumperLightBar.updatePreviousState(); // Update previous state to only run once as needed
         }
+
+        // Run always commands
+        indicatorBumperLightBar.updateColor(hudColor); // Update hud indicator
         
         break;
       case AUTO:
@@ -1278,16 +1767,19 @@ void updateOutputs(){
 
         if (switchBumperLightBar.checkPreviousState() != switchBumperLightBar.checkState()){ // Only run commands if the switch just changed state
           
-          indicatorBumperLightBar.updateColor(orange); // Update hud indicator
-
           switchBumperLightBar.updatePreviousState(); // Update previous state to only run once as needed
         }
+
+        // Run always commands
+        indicatorBumperLightBar.updateColor(orange); // Update hud indicator
         
         break;
     }
   }
+}
 
-  // Main Light Bar
+// Main Light Bar
+void handleMainLightBar(){
   if(allOnDecision){ // Force light on if All On mode is active
     indicatorMainLightBar.updateColor(green);
     mainLightBar.allMainLights(ON);
@@ -1335,13 +1827,10 @@ void updateOutputs(){
           Serial.println("Switch 01 - AUTO - Main Light Bar");
         }
 
-        // Run once commands
-        if (switchMainLightBar.checkPreviousState() != switchMainLightBar.checkState()){ // Only run commands if the switch just changed state
-          
-          //Decisions for Auto TBD
+        // Run when the switch or its auto decision just changed
+        mainLightBar.allMainLights(autoRuleEngine.checkDecision(SWITCH_MAIN_LIGHT_BAR) ? ON : OFF);
 
-          switchMainLightBar.updatePreviousState(); // Update previous state to only run once as needed
-        }
+        switchMainLightBar.updatePreviousState(); // Update previous state to only run once as needed
 
         // Run always commands
         indicatorMainLightBar.updateColor(orange); // Update Hud indicator
@@ -1349,44 +1838,34 @@ void updateOutputs(){
         break;
     }
   }
+}
 
-  // Side Light Bars
-  if(allOnDecision){ // Force light on if All On mode is active
-    indicatorSideLightBars.updateColor(green);
-    rightLightDecision = true; // Create and store a value to only fire relays once in Momentary Section
-    leftLightDecision = true; // Call to turn on both lights
-  } else {
-    switch (switchSideLightBars.checkState()) {
-      case ON:
-        // Print debug message
-        if (debugSwitches) {
-          Serial.println("Switch 02 - ON   - Side Lights");
-        }
-        indicatorSideLightBars.updateColor(green);
-        rightLightDecision = true; // Create and store a value to only fire relays once in Momentary Section
-        leftLightDecision = true; // Call to turn on both lights
-        break;
-      case OFF:
-        // Print debug message
-        if (debugSwitches) {
-          Serial.println("Switch 02 - OFF  - Side Lights");
-        }
-        indicatorSideLightBars.updateColor(hudColor);
-        rightLightDecision = false; // Call to turn off both lights
-        leftLightDecision = false;
-        break;
-      case AUTO:
-        // Print debug message
-        if (debugSwitches) {
-          Serial.println("Switch 02 - AUTO - Side Lights");
-        }
-        indicatorSideLightBars.updateColor(orange);
-        //Decisions for Auto TBD
-        break;
-    }
+// Side Light Bars - the lights and indicator are set in updateSideLights()
+void handleSideLightBars(){
+  switch (switchSideLightBars.checkState()) {
+    case ON:
+      // Print debug message
+      if (debugSwitches) {
+        Serial.println("Switch 02 - ON   - Side Lights");
+      }
+      break;
+    case OFF:
+      // Print debug message
+      if (debugSwitches) {
+        Serial.println("Switch 02 - OFF  - Side Lights");
+      }
+      break;
+    case AUTO:
+      // Print debug message
+      if (debugSwitches) {
+        Serial.println("Switch 02 - AUTO - Side Lights");
+      }
+      break;
   }
+}
 
-  // Rear Light Bar
+// Rear Light Bar
+void handleRearLightBar(){
   if(allOnDecision){ // Force light on if All On mode is active
     indicatorRearLightBar.updateColor(green);
     rearLightBar.allMainLights(ON);
@@ -1434,13 +1913,10 @@ void updateOutputs(){
           Serial.println("Switch 03 - AUTO - Rear Light Bar");
         }
 
-        // Run once commands
-        if (switchRearLightBar.checkPreviousState() != switchRearLightBar.checkState()){ // Only run commands if the switch just changed state
-          
-          //Decisions for Auto TBD
+        // Run when the switch or its auto decision just changed
+        rearLightBar.allMainLights(autoRuleEngine.checkDecision(SWITCH_REAR_LIGHT_BAR) ? ON : OFF);
 
-          switchRearLightBar.updatePreviousState(); // Update previous state to only run once as needed
-        }
+        switchRearLightBar.updatePreviousState(); // Update previous state to only run once as needed
 
         // Run always commands
         indicatorRearLightBar.updateColor(orange); // Update Hud indicator
@@ -1448,8 +1924,10 @@ void updateOutputs(){
         break;
     }
   }
+}
 
-  // GMRS Radio
+// GMRS Radio
+void handleGMRSRadio(){
   switch (switchGMRSRadio.checkState()) {
     case ON:
       // Print debug message
@@ -1465,7 +1943,6 @@ void updateOutputs(){
 
       // Run always Commands
       indicatorGMRSRadio.updateColor(green); // Update Hud indicator
-      Shift_0Current = Shift_0Current + 128; // Add corresponding enumerated value to build 5v Output Shift Registers data
 
       break;
     case OFF:
@@ -1477,14 +1954,11 @@ void updateOutputs(){
       // Run once commands
       if (switchGMRSRadio.checkPreviousState() != switchGMRSRadio.checkState()){ // Only run commands if the switch just changed state
 
-        indicatorGMRSRadio.updateColor(hudColor); // Update Hud indicator
-
         switchGMRSRadio.updatePreviousState(); // Update previous state to only run once as needed
       }
 
       // Run always commands
-      
-      // None currently
+      indicatorGMRSRadio.updateColor(hudColor); // Update Hud indicator
 
       break;
     case AUTO:
@@ -1496,19 +1970,18 @@ void updateOutputs(){
       // Run once commands
       if (switchGMRSRadio.checkPreviousState() != switchGMRSRadio.checkState()){ // Only run commands if the switch just changed state
 
-        indicatorGMRSRadio.updateColor(orange); // Update Hud indicator
-
         switchGMRSRadio.updatePreviousState(); // Update previous state to only run once as needed
       }
 
       // Run always commands
-      
-      // None currently
+      indicatorGMRSRadio.updateColor(orange); // Update Hud indicator
       
       break;
   }
+}
 
-  // Tunes Radio
+// Tunes Radio
+void handleTunesRadio(){
   switch (switchTunesRadio.checkState()) {
     case ON:
       // Print debug message
@@ -1524,7 +1997,6 @@ void updateOutputs(){
 
       // Run always commands
       indicatorTunesRadio.updateColor(green); // Update Hud indicator
-      Shift_0Current = Shift_0Current + 64; // Add corresponding enumerated value to build 5v Output Shift Registers data
 
       break;
     case OFF:
@@ -1560,8 +2032,10 @@ void updateOutputs(){
       
       break;
   }
+}
 
-  // Night Signal
+// Night Signal
+void handleNightSignal(){
   switch (switchNightSignal.checkState()) {
     case ON:
       // Print debug message
@@ -1572,14 +2046,11 @@ void updateOutputs(){
       // Run once commands
       if (switchNightSignal.checkPreviousState() != switchNightSignal.checkState()){ // Only run commands if the switch just changed state
 
-        sideLightBars.chaseLights(OFF); // Make sure chase lights are turned off if night signal has been turned ON
-
         switchNightSignal.updatePreviousState(); // Update previous state to only run once as needed
       }
 
       // Run always commands
       indicatorNightSignal.updateColor(green); // Update Hud indicator
-      Shift_0Current = Shift_0Current + 32; // Add corresponding enumerated value to build 5v Output Shift Registers data
 
       break;
     case OFF:
@@ -1591,10 +2062,6 @@ void updateOutputs(){
       // Run once commands
       if (switchNightSignal.checkPreviousState() != switchNightSignal.checkState()){ // Only run commands if the switch just changed state
 
-        if (switchOffRoadMode.checkState() == ON){
-          sideLightBars.chaseLights(ON); // Turn Chaselights on if we are just turning the night signal OFF
-        }
-
         switchNightSignal.updatePreviousState(); // Update previous state to only run once as needed
       }
 
@@ -1619,16 +2086,16 @@ void updateOutputs(){
 
       break;
   }
+}
 
-  // Side Light Bars Momentary
+// Side Light Bars Momentary - the lights and indicator are set in updateSideLights()
+void handleMomentarySideLightBars(){
   switch (switchMomentarySideLightBars.checkState()) {
     case LEFT:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 07 - LEFT - Side Light Bars Momentary");
       }
-      indicatorSideLightBars.updateColor(green);
-      leftLightDecision = true; // Call to turn left light on
       break;
     case OFF:
       // Print debug message
@@ -1642,48 +2109,42 @@ void updateOutputs(){
       if (debugSwitches) {
         Serial.println("Switch 07 - RIGT - Side Light Bars Momentary");
       }
-      indicatorSideLightBars.updateColor(green);
-      rightLightDecision = true; // Call to turn right light on
       break;
   }
+}
 
-  // Drivers Side Map Light
+// Drivers Side Map Light - the light is set in updateAreaLights()
+void handleDriversMapLight(){
   switch (switchDriversMapLight.checkState()) {
     case ON:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 14 - ON   - Drivers Side Map Light");
       }
-      // Turn on map light
-      driversSideMapLightDecision = true;
       break;
     case OFF:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 14 - OFF  - Drivers Side Map Light");
       }
-      // Turn off map light
-      driversSideMapLightDecision = false;
       break;
   }
+}
 
-  // Dome Light Mode Select
+// Dome Light Mode Select - the light is set in updateAreaLights()
+void handleDomeLightSelect(){
   switch (switchDomeLightSelect.checkState()) {
     case ON:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 15 - ON   - Dome Light Mode Select");
       }
-      // Turn on dome light
-      domeLightDecision = true;
       break;
     case OFF:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 15 - OFF  - Dome Light Mode Select");
       }
-      // Turn on dome light
-      domeLightDecision = false;
       break;
     case DOOR:
       // Print debug message
@@ -1693,33 +2154,146 @@ void updateOutputs(){
       // Add Functionalality
       break;
   }
+}
 
-  // Passengers Side Map Light
+// Passengers Side Map Light - the light is set in updateAreaLights()
+void handlePassengerMapLight(){
   switch (switchPassengerMapLight.checkState()) {
     case ON:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 16 - ON   - Passengers Side Map Light");
       }
-      // Turn on map light
-      passengersSideMapLightDecision = true;
       break;
     case OFF:
       // Print debug message
       if (debugSwitches) {
         Serial.println("Switch 16 - OFF  - Passengers Side Map Light");
       }
-      // Turn off map light
-      passengersSideMapLightDecision = false;
       break;
   }
+}
 
-  // Print debug message
-      if (debugSwitches) {
-        Serial.println("----------------------------------------");
-      }
+// Scene a mode is showing, SCENE_NONE if its switch is off
+byte modeScene(byte m){
+  PanelSwitch *modeSwitch = (PanelSwitch *)pgm_read_ptr(&switchInputs[pgm_read_byte(&modeScenes[m].modeSwitch)].panelSwitch);
 
-  // ---Final evaluations---
+  if(modeSwitch->checkState() != ON){
+    return SCENE_NONE;
+  }
+
+  byte scene = pgm_read_byte(&modeScenes[m].scene);
+  switch(pgm_read_byte(&modeScenes[m].select)){
+    case SCENE_SELECT_HAZARD_DIRECTION:
+      scene += switchHazardModeSelect.checkState();
+      break;
+    case SCENE_SELECT_OFF_ROAD_PATTERN:
+      scene += currentOffRoadPattern;
+      break;
+  }
+  return scene;
+}
+
+// Scene of the highest priority active mode, SCENE_OFF if no mode is active
+byte activeScene(){
+  for(byte m = 0; m < MODE_SCENE_COUNT; m++){
+    byte scene = modeScene(m);
+
+    if(scene != SCENE_NONE){
+      return scene;
+    }
+  }
+
+  return SCENE_OFF;
+}
+
+// SCENE_CHASE bits of a bar from every active mode.  The chase relay is not
+// part of the RGB lights the modes take turns at, so Hazard over Off Road
+// leaves Off Road's chase lights on.
+byte activeSceneRelays(byte bar){
+  byte relays = 0;
+
+  for(byte m = 0; m < MODE_SCENE_COUNT; m++){
+    byte scene = modeScene(m);
+
+    if(scene != SCENE_NONE){
+      relays |= pgm_read_byte(&scenes[scene].bars[bar].relays);
+    }
+  }
+
+  return relays;
+}
+
+// RGB lights of the bars, from the scene of the highest priority active mode,
+// and their chase lights from every active mode
+void updateModeLayers(){
+  const Scene *scene = &scenes[activeScene()];
+
+  modeLayersPending = false;
+
+  for(byte bar = 0; bar < RGB_BAR_COUNT; bar++){
+    BarScene desired;
+    I2CDevice *device = rgbBars[bar];
+
+    memcpy_P(&desired, &scene->bars[bar], sizeof(desired));
+    byte relays = activeSceneRelays(bar);
+    boolean chase = (relays & SCENE_CHASE) || ((relays & SCENE_CHASE_DAYTIME) && !nightSignalOn());
+
+    // The device's mirror drops whatever the bar already shows.  Brightness
+    // first, so the new pattern starts out at it.
+    device->clearCommandRefused();
+    device->RGBBrightness(desired.brightness);
+    device->RGBPattern(desired.pattern, desired.option);
+    device->chaseLights(chase ? ON : OFF);
+
+    if(device->checkCommandCount()){
+      device->holdForScene();
+    }
+
+    if(device->checkCommandRefused()){ // The bar's frame was full, taskLogic() tries the scene again
+      modeLayersPending = true;
+    }
+  }
+}
+
+// Side lights and their indicator, from the Side Light Bars switch, the
+// Side Light Bars Momentary switch and All On mode
+void updateSideLights(){
+  boolean rightLightDecision = false; // Variable to evaluate turning on the right lights
+  boolean leftLightDecision = false; // Variable to evaluate turning on the left lights
+
+  if(allOnDecision){ // Force light on if All On mode is active
+    indicatorSideLightBars.updateColor(green);
+    rightLightDecision = true;
+    leftLightDecision = true;
+  } else {
+    switch (switchSideLightBars.checkState()) {
+      case ON:
+        indicatorSideLightBars.updateColor(green);
+        rightLightDecision = true; // Call to turn on both lights
+        leftLightDecision = true;
+        break;
+      case OFF:
+        indicatorSideLightBars.updateColor(hudColor);
+        break;
+      case AUTO:
+        indicatorSideLightBars.updateColor(orange);
+        rightLightDecision = autoRuleEngine.checkDecision(SWITCH_SIDE_LIGHT_BARS);
+        leftLightDecision = rightLightDecision;
+        break;
+    }
+  }
+
+  switch (switchMomentarySideLightBars.checkState()) {
+    case LEFT:
+      indicatorSideLightBars.updateColor(green);
+      leftLightDecision = true; // Call to turn left light on
+      break;
+    case RIGHT:
+      indicatorSideLightBars.updateColor(green);
+      rightLightDecision = true; // Call to turn right light on
+      break;
+  }
 
   // Evaluate if side lights need to be on
   if (leftLightDecision && rightLightDecision) {
@@ -1751,6 +2325,13 @@ void updateOutputs(){
     }
     
   }
+}
+
+// Map and dome lights, from the two map light switches and the Dome Light Mode Select
+void updateAreaLights(){
+  boolean driversSideMapLightDecision = switchDriversMapLight.checkState() == ON; // Variable to evaluate turning on the Drivers side map light
+  boolean passengersSideMapLightDecision = switchPassengerMapLight.checkState() == ON; // Variable to evaluate turning on the Passengers side map light
+  boolean domeLightDecision = switchDomeLightSelect.checkState() == ON; // Variable to evaluate turning on the dome light, DOOR TBD
 
   // Evaluate Drivers side map light
   if (driversSideMapLightDecision or domeLightDecision){
@@ -1774,6 +2355,29 @@ void updateOutputs(){
   } else {
     areaLightPassengerMap.updateColor(off);
   }
+}
+
+// 5v Output Shift Registers, from the GMRS Radio, Tunes Radio and Night Signal switches
+void updateOutputShiftRegisters(){
+  byte Shift_0Current = 0; // Binary enumerated value to update the 5v Output Shift Registers
+
+  /*
+  Shift Register Values
+  Output  Value   Name
+  1       128     GMRS Radio
+  2       64      Tunes Radio
+  3       32      Night Signal
+  */
+
+  if(switchGMRSRadio.checkState() == ON){
+    Shift_0Current = Shift_0Current + 128;
+  }
+  if(switchTunesRadio.checkState() == ON){
+    Shift_0Current = Shift_0Current + 64;
+  }
+  if(nightSignalOn()){
+    Shift_0Current = Shift_0Current + 32;
+  }
 
   // Update 5v Output Shift Registers if a change has happened
   if (Shift_0Current != Shift_0Last) {
@@ -1788,34 +2392,147 @@ void updateOutputs(){
 
     Shift_0Last = Shift_0Current; // Store current value
   }
+}
+
+// Send every I2C device the commands queued for it.  When more than one device
+// has commands they all go out in one general call frame, so every bar gets
+// them in the same transaction and starts on them at the same moment.  While
+// any bar of a scene is settling the other bars of it wait too, so a bar that
+// had to power up does not start the scene after the rest.
+void sendI2CFrames(){
+  byte targetMasks[I2C_DEVICE_COUNT]; // Boards sharing each device's commands, 0 if it joined an earlier device
+  boolean ready[I2C_DEVICE_COUNT];
+  boolean sceneSettling = false;
+  byte pendingDevices = 0;
+  byte broadcastCommands = 0;
+
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    if(i2cDevices[d].checkSceneHeld() && !i2cDevices[d].checkReady()){
+      sceneSettling = true;
+    }
+  }
+
+  // Group devices that have the same commands waiting
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    targetMasks[d] = 0;
+    ready[d] = i2cDevices[d].checkReady() && !(sceneSettling && i2cDevices[d].checkSceneHeld());
+
+    if(i2cDevices[d].checkCommandCount() == 0 || !ready[d]){ // Nothing to send, or the device or its scene is still settling
+      continue;
+    }
+    pendingDevices ++;
+
+    boolean grouped = false;
+    for(byte e = 0; e < d; e++){
+      if(targetMasks[e] && i2cDevices[e].sameCommands(i2cDevices[d])){
+        targetMasks[e] |= I2C_TARGET_MASK(i2cDevices[d].checkAddress());
+        grouped = true;
+        break;
+      }
+    }
+
+    if(!grouped){
+      targetMasks[d] = I2C_TARGET_MASK(i2cDevices[d].checkAddress());
+      broadcastCommands += 1 + i2cDevices[d].checkCommandCount(); // Target select plus the commands
+    }
+  }
+
+  // Only one device, or too much for one frame - send each device its own
+  if(pendingDevices < 2 || broadcastCommands > I2C_FRAME_MAX_COMMANDS){
+    for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+      if(ready[d]){
+        i2cDevices[d].sendFrame();
+      }
+    }
+    return;
+  }
+
+  byte frame[I2C_FRAME_MAX_LENGTH];
+  byte count = 0;
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    if(targetMasks[d]){
+      frame[2 * count + 1] = I2C_SELECT_TARGETS;
+      frame[2 * count + 2] = targetMasks[d];
+      count ++;
+      count += i2cDevices[d].copyCommands(&frame[2 * count + 1]);
+    }
+  }
+
+  boolean acknowledged = sendI2CFrame(I2C_GENERAL_CALL_ADDRESS, frame, i2cFrameFinish(frame, count));
+
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    if(ready[d] && i2cDevices[d].checkCommandCount()){ // Devices still waiting were not in the frame
+      i2cDevices[d].clearCommands(acknowledged, true);
+    }
+  }
+}
+
+// Commands the light bars did not need, over every device
+unsigned int checkSuppressedI2CCommands(){
+  unsigned int suppressed = 0;
+
+  for(byte d = 0; d < I2C_DEVICE_COUNT; d++){
+    suppressed += i2cDevices[d].checkSuppressedCommands();
+  }
+
+  return suppressed;
+}
+
+// Broadcast the time and a new random seed to every Nano (see CarduinoSync.h).
+// Goes out on its own so the message LED only shows real commands.
+void sendTimeSync(){
+  byte frame[I2C_FRAME_LENGTH(1 + I2C_SYNC_DATA_PAIRS)];
+  unsigned long time = millis();
+
+  i2c_sync_timer = time;
+  i2c_sync_seed ++;
+
+  if(!i2c_active){
+    return;
+  }
 
-  InputUpdated = false; // Turn off flag to keep UpdateOutputs() from running when nothing has changed.
+  frame[1] = I2C_SYNC;
+  frame[2] = i2c_sync_seed;
+  frame[3] = time >> 24;
+  frame[4] = time >> 16;
+  frame[5] = time >> 8;
+  frame[6] = time;
+
+  if (debugI2C) {
+    Serial.print("Sending time sync: ");
+    Serial.println(time);
+  }
+
+  Wire.beginTransmission(I2C_GENERAL_CALL_ADDRESS);
+  Wire.write(frame, i2cFrameFinish(frame, 1 + I2C_SYNC_DATA_PAIRS));
+  Wire.endTransmission();
 }
 
-void sendI2CMessage(byte address, byte pattern, byte option){
+// Returns true if the frame was acknowledged
+boolean sendI2CFrame(byte address, const byte *frame, byte length){
+  boolean acknowledged = false;
+
   if(i2c_active){
     if (debugI2C) {
-      Serial.print("Sending I2C Message to ");
+      Serial.print("Sending I2C Frame to ");
       Serial.print(address);
       Serial.print(":");
-      Serial.print(pattern);
-      Serial.print(",");
-      Serial.println(option);
+      for(byte i = 0; i < frame[0]; i++){
+        Serial.print(" ");
+        Serial.print(frame[2 * i + 1]);
+        Serial.print(",");
+        Serial.print(frame[2 * i + 2]);
+      }
+      Serial.println();
     }
 
-    // Add small delay to solve race condition - !!! WORK TO FIX THIS SOME OTHER WAY !!!
-    //delay(10);
-
-    // Transmit Message
+    // Transmit Frame
     Wire.beginTransmission(address);
-    Wire.write(pattern);
-    if (option != 255){
-      Wire.write(option);
-    }
-    Wire.endTransmission();
+    Wire.write(frame, length);
+    acknowledged = Wire.endTransmission() == 0;
 
     if (debugI2C) {
-      Serial.println("I2C Message Sent");
+      Serial.println(acknowledged ? "I2C Frame Sent" : "I2C Frame Not Acknowledged");
     }
 
     // Begin flash of message LED
@@ -1826,4 +2543,6 @@ void sendI2CMessage(byte address, byte pattern, byte option){
       Serial.println("I2C Currently Disabled.  No message sent");
     }
   }
+
+  return acknowledged;
 }
@@ -0,0 +1,184 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Interrupt driven scan of *
+*                 the analog sensors       *
+*                                          *
+********************************************
+*/
+
+// Keeps the ADC converting the sensor channels in the background, so loop()
+// never waits the ~110 us an analogRead() takes.  Each conversion complete
+// interrupt takes the reading, sets up the next channel and starts the next
+// conversion.  Every channel is read ANALOG_OVERSAMPLES times in a row and
+// the readings summed, which gives two more bits than the ADC has, then the
+// sum goes through an exponential moving average kept in fixed point:
+//
+//   average += sum - average / 2^ANALOG_EMA_SHIFT
+//
+// average / 2^ANALOG_EMA_SHIFT is the filtered value.  It is in 1/16ths of
+// an ADC count, 0 to 1023 * 16, and is read with checkValue().  The first
+// conversion after the channel changes is thrown away while the sample and
+// hold settles on the new input.
+//
+// With the ADC clock at 125 kHz a conversion takes 104 us, so a channel is
+// filtered again every (ANALOG_OVERSAMPLES + 1) * 104 us times the number of
+// channels, about 3.5 ms for two.
+//
+// The scanner owns the ADC.  Nothing else may call analogRead() once begin()
+// has been called.  The interrupt runs whichever scanner begin() was last
+// called on.
+
+#ifndef CARDUINO_ANALOG_SCANNER_H
+#define CARDUINO_ANALOG_SCANNER_H
+
+#include <Arduino.h>
+
+#define ANALOG_OVERSAMPLES 16            // Readings summed into each filter update
+#define ANALOG_SETTLE_CONVERSIONS 1      // Readings thrown away after a channel change
+#define ANALOG_EMA_SHIFT 3               // Filter weight of each new sum, 1 / 2^ANALOG_EMA_SHIFT
+#define ANALOG_VALUE_SCALE ANALOG_OVERSAMPLES // Filtered values are ADC counts times this
+#define ANALOG_CONVERSION_MICROS 104     // 13 ADC clocks at 16 MHz / 128
+
+// The conversion complete handler, set by begin()
+void (*analogScanInterrupt)(uint16_t reading) = NULL;
+
+#ifdef __AVR__
+ISR(ADC_vect){
+  if(analogScanInterrupt){
+    analogScanInterrupt(ADC);
+  }
+}
+#endif
+
+template<byte CHANNELS>
+class AnalogScanner {
+  private:
+
+    byte channels[CHANNELS];              // ADC channel of each sensor, A0 is 0
+    uint32_t averages[CHANNELS];          // Filter state, value << ANALOG_EMA_SHIFT
+    volatile uint16_t values[CHANNELS];   // Filtered values
+    volatile unsigned long updates[CHANNELS]; // Filter updates of each channel since begin()
+    byte current = 0;                     // Index of the channel being converted
+    byte settling = ANALOG_SETTLE_CONVERSIONS;
+    byte sampleCount = 0;
+    uint16_t sampleSum = 0;
+
+    static AnalogScanner *running; // The scanner begin() was last called on
+
+    static void interrupt(uint16_t reading){
+      running->conversionComplete(reading);
+    }
+
+#ifndef __AVR__
+    // Stand-in for the ADC on the host - one timer interrupt runs every
+    // conversion of a channel, which keeps the simulator from switching to
+    // the Mega every 104 us
+    static void hostConversions(){
+      for(byte i = 0; i < ANALOG_SETTLE_CONVERSIONS + ANALOG_OVERSAMPLES; i++){
+        interrupt(hostReadAnalogInput(running->channels[running->current]));
+      }
+    }
+#endif
+
+    void selectChannel(){
+#ifdef __AVR__
+      byte channel = channels[current];
+
+      ADMUX = _BV(REFS0) | (channel & 0x07); // AVcc reference
+#ifdef MUX5
+      if(channel & 0x08){
+        ADCSRB |= _BV(MUX5);
+      } else {
+        ADCSRB &= ~_BV(MUX5);
+      }
+#endif
+#endif
+    }
+
+    void startConversion(){
+#ifdef __AVR__
+      ADCSRA |= _BV(ADSC);
+#endif
+    }
+
+  public:
+
+    // Constructor
+    AnalogScanner(const byte *channels){
+      for(byte i = 0; i < CHANNELS; i++){
+        this->channels[i] = channels[i];
+        averages[i] = 0;
+        values[i] = 0;
+        updates[i] = 0;
+      }
+    }
+
+    // Methods
+    void begin(){
+      running = this;
+      analogScanInterrupt = interrupt;
+      selectChannel();
+
+#ifdef __AVR__
+      ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0); // ADC clock 16 MHz / 128
+      startConversion();
+#else
+      hostAttachTimerInterrupt((unsigned long)ANALOG_CONVERSION_MICROS * (ANALOG_SETTLE_CONVERSIONS + ANALOG_OVERSAMPLES), hostConversions);
+#endif
+    }
+
+    // Called from the conversion complete interrupt
+    void conversionComplete(uint16_t reading){
+      if(settling){
+        settling --;
+      } else {
+        sampleSum += reading;
+        sampleCount ++;
+
+        if(sampleCount == ANALOG_OVERSAMPLES){
+          if(updates[current] == 0){
+            averages[current] = (uint32_t)sampleSum << ANALOG_EMA_SHIFT; // Start the filter at the first sum instead of climbing up from 0
+          } else {
+            averages[current] += sampleSum - (averages[current] >> ANALOG_EMA_SHIFT);
+          }
+          values[current] = averages[current] >> ANALOG_EMA_SHIFT;
+          updates[current] ++;
+
+          sampleSum = 0;
+          sampleCount = 0;
+          if(CHANNELS > 1){
+            current = current + 1 < CHANNELS ? current + 1 : 0;
+            settling = ANALOG_SETTLE_CONVERSIONS;
+            selectChannel();
+          }
+        }
+      }
+
+      startConversion();
+    }
+
+    // Filtered value of a sensor, in ADC counts times ANALOG_VALUE_SCALE
+    uint16_t checkValue(byte sensor){
+      noInterrupts();
+      uint16_t value = values[sensor];
+      interrupts();
+      return value;
+    }
+
+    // Filter updates of a sensor since begin(), 0 until its first value is in
+    unsigned long checkUpdates(byte sensor){
+      noInterrupts();
+      unsigned long count = updates[sensor];
+      interrupts();
+      return count;
+    }
+
+};
+
+template<byte CHANNELS>
+AnalogScanner<CHANNELS> *AnalogScanner<CHANNELS>::running = NULL;
+
+#endif
@@ -0,0 +1,148 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Rule table for the AUTO  *
+*                 switch positions         *
+*                                          *
+********************************************
+*/
+
+// Decides what an output in AUTO should do from a table of rules.  The
+// inputs to the rules are conditions, one bit each in a 16 bit word: car
+// signals, sensor thresholds and mode switches.  A rule names the output it
+// decides for, the conditions that must be on and the conditions that must
+// be off.  An output's decision is on when any of its rules holds.
+//
+// update() only looks at the rules that read a condition that changed since
+// the last call, and returns the outputs whose decision changed, so a pass
+// where no condition moved costs one compare.  Outputs are numbered 0 to 31
+// and the decisions are a mask of them.
+//
+// A threshold turns a sensor reading into a condition with some hysteresis:
+// the condition goes on at onLevel and off again at offLevel.  With onLevel
+// below offLevel it goes on as the reading falls, otherwise as it rises.
+
+#ifndef CARDUINO_AUTO_RULES_H
+#define CARDUINO_AUTO_RULES_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+struct AutoRule {
+  byte output;       // Output the rule decides for, 0 to 31
+  uint16_t inputs;   // Conditions the rule reads
+  uint16_t required; // What those conditions have to be for the rule to hold
+};
+
+// Output on when every condition in when is on and every condition in unless is off
+#define AUTO_RULE(output, when, unless) {output, (uint16_t)((when) | (unless)), (uint16_t)(when)}
+
+struct AutoThreshold {
+  byte sensor;        // Sensor the reading comes from
+  uint16_t condition; // Condition bit it sets
+  uint16_t onLevel;   // Reading the condition goes on at
+  uint16_t offLevel;  // Reading it goes off again at
+};
+
+// New state of a threshold's condition for a reading
+inline boolean autoThresholdState(uint16_t onLevel, uint16_t offLevel, uint16_t reading, boolean on){
+  if(onLevel < offLevel){ // On as the reading falls
+    return on ? reading < offLevel : reading <= onLevel;
+  }
+  return on ? reading > offLevel : reading >= onLevel;
+}
+
+template<byte RULES>
+class AutoRuleEngine {
+  static_assert(RULES <= 32, "ruleStates has one bit per rule");
+
+  private:
+
+    const AutoRule *rules; // In PROGMEM
+    uint16_t conditions = 0;
+    uint32_t ruleStates = 0; // Rules that hold
+    uint32_t decisions = 0;  // Outputs with a rule that holds
+
+    boolean ruleHolds(byte r){
+      return (conditions & pgm_read_word(&rules[r].inputs)) == pgm_read_word(&rules[r].required);
+    }
+
+    // Check every rule of an output
+    boolean outputDecision(byte output){
+      for(byte r = 0; r < RULES; r++){
+        if((ruleStates & (1UL << r)) && pgm_read_byte(&rules[r].output) == output){
+          return true;
+        }
+      }
+      return false;
+    }
+
+  public:
+
+    // Constructor
+    AutoRuleEngine(const AutoRule *rules){
+      this->rules = rules;
+    }
+
+    // Methods
+
+    // Work out every rule from scratch, for conditions that are all off
+    void begin(){
+      ruleStates = 0;
+      decisions = 0;
+      for(byte r = 0; r < RULES; r++){
+        if(ruleHolds(r)){
+          ruleStates |= 1UL << r;
+          decisions |= 1UL << pgm_read_byte(&rules[r].output);
+        }
+      }
+    }
+
+    // Take in the conditions, returns the outputs whose decision changed
+    uint32_t update(uint16_t newConditions){
+      uint16_t changed = conditions ^ newConditions;
+
+      if(!changed){
+        return 0;
+      }
+      conditions = newConditions;
+
+      // Rules that read a changed condition
+      uint32_t changedRules = 0;
+      for(byte r = 0; r < RULES; r++){
+        if((pgm_read_word(&rules[r].inputs) & changed) && ruleHolds(r) != ((ruleStates & (1UL << r)) != 0)){
+          ruleStates ^= 1UL << r;
+          changedRules |= 1UL << r;
+        }
+      }
+
+      // Outputs of those rules
+      uint32_t oldDecisions = decisions;
+      for(byte r = 0; changedRules; r++, changedRules >>= 1){
+        if(changedRules & 1){
+          byte output = pgm_read_byte(&rules[r].output);
+
+          if(outputDecision(output)){
+            decisions |= 1UL << output;
+          } else {
+            decisions &= ~(1UL << output);
+          }
+        }
+      }
+
+      return decisions ^ oldDecisions;
+    }
+
+    boolean checkDecision(byte output){
+      return decisions & (1UL << output);
+    }
+
+    uint16_t checkConditions(){
+      return conditions;
+    }
+
+};
+
+#endif
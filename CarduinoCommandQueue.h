@@ -0,0 +1,85 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano 1, 2 and 3          *
+*    Description: Queue of I2C commands    *
+*                 from the receive handler *
+*                 to loop()                *
+*                                          *
+********************************************
+*/
+
+// Single producer (the I2C receive interrupt), single consumer (loop()), so
+// it needs no locking: only the interrupt moves head and only loop() moves
+// tail, and both are single bytes, which the AVR reads and writes in one
+// instruction.  When the queue is full the new command is dropped and
+// counted, instead of overwriting one that has not run yet.
+
+#ifndef CARDUINO_COMMAND_QUEUE_H
+#define CARDUINO_COMMAND_QUEUE_H
+
+#include <Arduino.h>
+
+#define COMMAND_QUEUE_SIZE 16 // Must be a power of two, big enough for a full I2C frame
+#define COMMAND_QUEUE_MASK (COMMAND_QUEUE_SIZE - 1)
+
+class CommandQueue {
+  private:
+    byte patterns[COMMAND_QUEUE_SIZE];
+    byte options[COMMAND_QUEUE_SIZE];
+    volatile byte head = 0; // Next slot to write, interrupt side
+    volatile byte tail = 0; // Next slot to read, loop() side
+    volatile unsigned int dropCount = 0;
+
+  public:
+
+    // Methods
+
+    // Interrupt side - returns false if the queue was full and the command was dropped
+    boolean push(byte pattern, byte option){
+      byte currentHead = head;
+
+      if((byte)(currentHead - tail) == COMMAND_QUEUE_SIZE){
+        dropCount ++;
+        return false;
+      }
+
+      patterns[currentHead & COMMAND_QUEUE_MASK] = pattern;
+      options[currentHead & COMMAND_QUEUE_MASK] = option;
+      head = currentHead + 1; // Publish only once the slot is filled in
+
+      return true;
+    }
+
+    // loop() side - returns false if there is nothing waiting
+    boolean pop(byte &pattern, byte &option){
+      byte currentTail = tail;
+
+      if(currentTail == head){
+        return false;
+      }
+
+      pattern = patterns[currentTail & COMMAND_QUEUE_MASK];
+      option = options[currentTail & COMMAND_QUEUE_MASK];
+      tail = currentTail + 1; // Hand the slot back only once it has been read
+
+      return true;
+    }
+
+    boolean checkEmpty(){
+      return tail == head;
+    }
+
+    // Number of commands dropped because the queue was full.  Two bytes wide,
+    // so read with interrupts off to avoid catching it halfway through an update.
+    unsigned int checkDropCount(){
+      noInterrupts();
+      unsigned int drops = dropCount;
+      interrupts();
+
+      return drops;
+    }
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega and Nanos      *
+*    Description: Light bar command set    *
+*                 and dispatch table       *
+*                                          *
+********************************************
+*/
+
+// The commands the Mega sends and the Nanos carry out, in one place.  The
+// opcodes are in two runs, 0 - 24 and 100 - 107, which commandIndex() packs
+// into one index with no gaps.  Each Nano keeps a table of handlers in flash
+// in that index order and dispatchCommand() looks the handler up directly,
+// instead of stepping through a switch with a case for every opcode.  A NULL
+// handler means the board has nothing to do for that command.
+
+#ifndef CARDUINO_COMMANDS_H
+#define CARDUINO_COMMANDS_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "CarduinoProtocol.h"
+
+// Opcodes
+#define CMD_RGB_POWER_OFF 0        // RGB Light Bar(s) Power OFF
+#define CMD_RGB_POWER_ON 1         // RGB Light Bar(s) Power On
+#define CMD_ALL_OFF 2              // All lights OFF
+#define CMD_MAIN_OFF 3             // All main lights OFF
+#define CMD_MAIN_ON 4              // All main lights ON
+#define CMD_LEFT_MAIN_OFF 5        // Left main lights OFF
+#define CMD_LEFT_MAIN_ON 6         // Left (only) main lights ON
+#define CMD_RIGHT_MAIN_OFF 7       // Right main lights OFF
+#define CMD_RIGHT_MAIN_ON 8        // Right (only) main lights ON
+#define CMD_CHASE_OFF 9            // Chase lights OFF
+#define CMD_CHASE_ON 10            // Chase lights ON
+#define CMD_RGB_OFF 11             // RGB (All) OFF
+#define CMD_RGB_RED 12             // RGB (All) Red
+#define CMD_RGB_LEFT_RED 13        // RGB left Red
+#define CMD_RGB_RIGHT_RED 14       // RGB right Red
+#define CMD_TURN_LEFT_OFF 15       // Turn signal left OFF
+#define CMD_TURN_LEFT_ON 16        // Turn signal left ON
+#define CMD_TURN_RIGHT_OFF 17      // Turn signal right OFF
+#define CMD_TURN_RIGHT_ON 18       // Turn signal right ON
+#define CMD_BRAKE_OFF 19           // Brake OFF
+#define CMD_BRAKE_ON 20            // Brake ON
+#define CMD_CAUTION_CYCLE 21       // RGB caution pattern cycle
+#define CMD_HAZARD_LEFT 22         // RGB hazard left
+#define CMD_HAZARD_RIGHT 23        // RGB hazard right
+#define CMD_HAZARD_CENTER 24       // RGB hazard center
+#define CMD_RGB_SOLID 100          // RGB (all) Solid - option is an RGB_COLOR_
+#define CMD_RGB_JUMP 101           // RGB (all) Full Jump Change Colors
+#define CMD_RGB_FADE 102           // RGB (all) Full fade change color
+#define CMD_RGB_FADE_OUT 103       // RGB (all) Full fade out change colors
+#define CMD_RGB_CHASE_FADE 104     // RGB (all) Chase Fade
+#define CMD_RGB_CHASE_FADE_OUT 105 // RGB (all) chase fade out
+#define CMD_RGB_RAINBOW 106        // RGB (all) Rainbow Road - option is a RAINBOW_ speed
+#define CMD_RGB_BRIGHTNESS 107     // RGB (all) Brightness - option is 0 - 255
+
+// Milliseconds the RGB relay takes to close and the LEDs to power up after
+// CMD_RGB_POWER_ON.  The Mega sends a powered up board nothing else until then.
+#define RGB_POWER_SETTLE_TIME 30
+
+// CMD_RGB_SOLID options
+#define RGB_COLOR_OFF 0
+#define RGB_COLOR_WHITE 1
+#define RGB_COLOR_RED 2
+#define RGB_COLOR_GREEN 3
+#define RGB_COLOR_BLUE 4
+#define RGB_COLOR_ORANGE 5
+#define RGB_COLOR_YELLOW 6
+#define RGB_COLOR_PURPLE 7
+
+// CMD_RGB_RAINBOW options
+#define RAINBOW_FULL_SPEED 80
+#define RAINBOW_FAST 81
+#define RAINBOW_MODERATE 82
+#define RAINBOW_SLOW 83
+
+// Table layout
+#define COMMAND_LOW_COUNT (CMD_HAZARD_CENTER + 1)                   // Opcodes 0 - 24
+#define COMMAND_HIGH_COUNT (CMD_RGB_BRIGHTNESS - CMD_RGB_SOLID + 1) // Opcodes 100 - 107
+#define COMMAND_COUNT (COMMAND_LOW_COUNT + COMMAND_HIGH_COUNT)
+#define COMMAND_NONE 255
+
+typedef void (*CommandHandler)(byte option);
+
+// Number of option bytes each command uses, in commandIndex() order.  The
+// option of a command that takes none is always sent as I2C_NO_OPTION.
+const byte commandOptionCounts[COMMAND_COUNT] PROGMEM = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0 - 9
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 10 - 19
+  0, 0, 0, 0, 0,                // 20 - 24
+  1, 0, 0, 0, 0, 0, 1, 1        // 100 - 107
+};
+
+// Table position of an opcode, or COMMAND_NONE if there is no such command.
+// constexpr so board profiles can build their command masks at compile time.
+constexpr byte commandIndex(byte opcode){
+  return opcode < COMMAND_LOW_COUNT ? opcode :
+         (opcode >= CMD_RGB_SOLID && opcode <= CMD_RGB_BRIGHTNESS) ? opcode - CMD_RGB_SOLID + COMMAND_LOW_COUNT :
+         COMMAND_NONE;
+}
+
+#define COMMAND_BIT(opcode) (1ULL << commandIndex(opcode)) // Bit for a command in a board's command mask, 64 bits wide
+
+// Check a command before it is sent.  Returns false for an unknown opcode,
+// otherwise clears the option of a command that does not take one.
+inline boolean commandPrepare(byte opcode, byte &option){
+  byte index = commandIndex(opcode);
+
+  if(index == COMMAND_NONE){
+    return false;
+  }
+
+  if(pgm_read_byte(&commandOptionCounts[index]) == 0){
+    option = I2C_NO_OPTION;
+  }
+
+  return true;
+}
+
+// Run the handler for a received command.  Returns false for an unknown opcode.
+inline boolean dispatchCommand(const CommandHandler *handlers, byte opcode, byte option){
+  byte index = commandIndex(opcode);
+
+  if(index == COMMAND_NONE){
+    return false;
+  }
+
+  CommandHandler handler = (CommandHandler)pgm_read_ptr(&handlers[index]);
+  if(handler){
+    if(pgm_read_byte(&commandOptionCounts[index]) == 0){
+      option = I2C_NO_OPTION;
+    }
+    handler(option);
+  }
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Bitwise debounce of the  *
+*                 packed switch inputs     *
+*                                          *
+********************************************
+*/
+
+// Debounces 32 inputs at a time with vertical counters: bit n of the three
+// counter words together is a 3 bit count of how many samples in a row
+// input n has differed from its debounced state.  An input takes its new
+// state once the count reaches the sample count of its class, and any sample
+// that agrees with the debounced state clears the count.  Momentary switches
+// and toggle switches each have their own sample count, 1 to 7.
+//
+// WORDS is the number of packed input words (see CarduinoInputChain.h).  The
+// work per word is the same handful of word operations however many of its
+// inputs are in use.
+
+#ifndef CARDUINO_DEBOUNCE_H
+#define CARDUINO_DEBOUNCE_H
+
+#include <Arduino.h>
+#include "CarduinoInputChain.h"
+
+#define DEBOUNCE_MAX_SAMPLES 7 // Largest count three counter bits can hold
+
+template<byte WORDS>
+class InputDebounce {
+  private:
+
+    uint32_t state[WORDS] = {};     // Debounced inputs
+    uint32_t count0[WORDS] = {};    // Vertical counter, bit 0 of every input's count
+    uint32_t count1[WORDS] = {};    // Bit 1
+    uint32_t count2[WORDS] = {};    // Bit 2
+    uint32_t target0[WORDS];        // Count at which each input changes state, bit 0
+    uint32_t target1[WORDS];        // Bit 1
+    uint32_t target2[WORDS];        // Bit 2
+    uint32_t momentaryMask[WORDS] = {};
+    byte momentarySamples;
+    byte toggleSamples;
+
+    // Spread one bit of each class's sample count over the inputs of that class
+    uint32_t targetBit(byte word, byte bit){
+      return ((momentarySamples >> bit) & 1 ? momentaryMask[word] : 0) | ((toggleSamples >> bit) & 1 ? ~momentaryMask[word] : 0);
+    }
+
+    void updateTargets(byte word){
+      target0[word] = targetBit(word, 0);
+      target1[word] = targetBit(word, 1);
+      target2[word] = targetBit(word, 2);
+    }
+
+  public:
+
+    // Constructor - every input starts out as a toggle
+    InputDebounce(byte momentarySamples, byte toggleSamples){
+      this->momentarySamples = constrain(momentarySamples, 1, DEBOUNCE_MAX_SAMPLES);
+      this->toggleSamples = constrain(toggleSamples, 1, DEBOUNCE_MAX_SAMPLES);
+      for(byte word = 0; word < WORDS; word++){
+        updateTargets(word);
+      }
+    }
+
+    // Methods
+
+    // Debounce an input with the momentary sample count.  Call before sampling starts.
+    void setMomentary(byte input){
+      momentaryMask[inputWord(input)] |= inputMask(input);
+      updateTargets(inputWord(input));
+    }
+
+    // Take in one sample of every input.  Fills in changed with the inputs
+    // whose debounced state changed and returns true if there were any.
+    boolean update(const uint32_t *sample, uint32_t *changed){
+      boolean anyChanged = false;
+
+      for(byte word = 0; word < WORDS; word++){
+        uint32_t differs = sample[word] ^ state[word];
+
+        // Count up where the sample differs, back to zero where it agrees
+        uint32_t next0 = ~count0[word] & differs;
+        uint32_t next1 = (count1[word] ^ count0[word]) & differs;
+        uint32_t next2 = (count2[word] ^ (count1[word] & count0[word])) & differs;
+
+        uint32_t wordChanged = ~((next0 ^ target0[word]) | (next1 ^ target1[word]) | (next2 ^ target2[word])) & differs;
+
+        state[word] ^= wordChanged;
+        count0[word] = next0 & ~wordChanged;
+        count1[word] = next1 & ~wordChanged;
+        count2[word] = next2 & ~wordChanged;
+
+        changed[word] = wordChanged;
+        if(wordChanged){
+          anyChanged = true;
+        }
+      }
+
+      return anyChanged;
+    }
+
+    const uint32_t *checkState(){
+      return state;
+    }
+
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Mirror of what a Nano's  *
+*                 lights were last told    *
+*                                          *
+********************************************
+*/
+
+// A compact copy of the state a Nano's lights were put in by the commands it
+// has been sent, so the Mega can drop a command that would leave the lights
+// as they already are.  deviceStateApply() works out what a command does to
+// the state (see the handlers in CarduinoNanoFirmware.h) and returns false if
+// it changes nothing that is known.
+//
+// Each light is a known bit and an on bit.  The RGB lights keep the last
+// command that sets all of them along with its option, and their brightness.
+// A command the mirror cannot follow, such as one that only changes one side
+// of the RGB lights, makes the RGB state unknown and always goes out.
+// Everything starts out unknown, so the first command of each kind is always
+// sent.
+
+#ifndef CARDUINO_DEVICE_STATE_H
+#define CARDUINO_DEVICE_STATE_H
+
+#include <Arduino.h>
+#include "CarduinoCommands.h"
+#include "CarduinoProtocol.h"
+
+// Lights with an on/off state
+#define DEVICE_STATE_POWER      0x01 // RGB power relay
+#define DEVICE_STATE_MAIN_LEFT  0x02
+#define DEVICE_STATE_MAIN_RIGHT 0x04
+#define DEVICE_STATE_CHASE      0x08
+#define DEVICE_STATE_BRIGHTNESS 0x10 // Known bit only, the level is in brightness
+#define DEVICE_STATE_RGB        0x20 // Only in deviceStateSets(), the RGB state is in rgbCommand
+#define DEVICE_STATE_MAIN       (DEVICE_STATE_MAIN_LEFT | DEVICE_STATE_MAIN_RIGHT)
+
+#define DEVICE_STATE_RGB_UNKNOWN 255 // rgbCommand when the RGB lights could be showing anything
+
+struct DeviceState {
+  byte known;      // DEVICE_STATE_ bits whose state is known
+  byte on;         // DEVICE_STATE_ bits that are on
+  byte rgbCommand; // Last command that set every RGB light, or DEVICE_STATE_RGB_UNKNOWN
+  byte rgbOption;
+  byte brightness; // RGB brightness, when DEVICE_STATE_BRIGHTNESS is known
+};
+
+inline void deviceStateForget(DeviceState &state){
+  state.known = 0;
+  state.on = 0;
+  state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+  state.rgbOption = I2C_NO_OPTION;
+  state.brightness = 0;
+}
+
+// Set the lights in mask to on, returns true if that was not already known
+inline boolean deviceStateSet(DeviceState &state, byte mask, byte on){
+  boolean changed = (state.known & mask) != mask || (state.on & mask) != on;
+
+  state.known |= mask;
+  state.on = (state.on & ~mask) | on;
+
+  return changed;
+}
+
+inline boolean deviceStateSetRGB(DeviceState &state, byte pattern, byte option){
+  boolean changed = state.rgbCommand != pattern || state.rgbOption != option;
+
+  state.rgbCommand = pattern;
+  state.rgbOption = option;
+
+  return changed;
+}
+
+// Apply a command to the state.  Returns false if the command would change nothing.
+inline boolean deviceStateApply(DeviceState &state, byte pattern, byte option){
+  switch(pattern){
+    case CMD_RGB_POWER_OFF: // The RGB LEDs lose what they were showing
+      state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+      return deviceStateSet(state, DEVICE_STATE_POWER, 0);
+    case CMD_RGB_POWER_ON:
+      return deviceStateSet(state, DEVICE_STATE_POWER, DEVICE_STATE_POWER);
+    case CMD_ALL_OFF: { // Main, chase and RGB lights all off, the power relay is left alone
+      boolean changed = deviceStateSet(state, DEVICE_STATE_MAIN | DEVICE_STATE_CHASE, 0);
+      return deviceStateSetRGB(state, CMD_RGB_OFF, I2C_NO_OPTION) || changed;
+    }
+    case CMD_MAIN_OFF:
+      return deviceStateSet(state, DEVICE_STATE_MAIN, 0);
+    case CMD_MAIN_ON:
+      return deviceStateSet(state, DEVICE_STATE_MAIN, DEVICE_STATE_MAIN);
+    case CMD_LEFT_MAIN_OFF:
+      return deviceStateSet(state, DEVICE_STATE_MAIN_LEFT, 0);
+    case CMD_LEFT_MAIN_ON: // Left only
+      return deviceStateSet(state, DEVICE_STATE_MAIN, DEVICE_STATE_MAIN_LEFT);
+    case CMD_RIGHT_MAIN_OFF:
+      return deviceStateSet(state, DEVICE_STATE_MAIN_RIGHT, 0);
+    case CMD_RIGHT_MAIN_ON: // Right only
+      return deviceStateSet(state, DEVICE_STATE_MAIN, DEVICE_STATE_MAIN_RIGHT);
+    case CMD_CHASE_OFF:
+      return deviceStateSet(state, DEVICE_STATE_CHASE, 0);
+    case CMD_CHASE_ON:
+      return deviceStateSet(state, DEVICE_STATE_CHASE, DEVICE_STATE_CHASE);
+    case CMD_RGB_OFF:
+    case CMD_RGB_RED:
+    case CMD_CAUTION_CYCLE:
+    case CMD_HAZARD_LEFT:
+    case CMD_HAZARD_RIGHT:
+    case CMD_HAZARD_CENTER:
+    case CMD_RGB_SOLID:
+    case CMD_RGB_RAINBOW:
+      return deviceStateSetRGB(state, pattern, option);
+    case CMD_RGB_BRIGHTNESS: { // Kept by the Nano through an RGB power off
+      boolean changed = !(state.known & DEVICE_STATE_BRIGHTNESS) || state.brightness != option;
+
+      state.known |= DEVICE_STATE_BRIGHTNESS;
+      state.brightness = option;
+      return changed;
+    }
+    default: // Only part of the RGB lights, or a command the mirror does not follow
+      state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+      return true;
+  }
+}
+
+// The DEVICE_STATE_ bits a command leaves the same whatever they were before,
+// so a later command that sets all of them makes it unneeded.  0 for the power
+// commands, which also time the frames, and for commands the mirror does not
+// follow.
+inline byte deviceStateSets(byte pattern){
+  switch(pattern){
+    case CMD_ALL_OFF:
+      return DEVICE_STATE_MAIN | DEVICE_STATE_CHASE | DEVICE_STATE_RGB;
+    case CMD_MAIN_OFF:
+    case CMD_MAIN_ON:
+    case CMD_LEFT_MAIN_ON:
+    case CMD_RIGHT_MAIN_ON:
+      return DEVICE_STATE_MAIN;
+    case CMD_LEFT_MAIN_OFF:
+      return DEVICE_STATE_MAIN_LEFT;
+    case CMD_RIGHT_MAIN_OFF:
+      return DEVICE_STATE_MAIN_RIGHT;
+    case CMD_CHASE_OFF:
+    case CMD_CHASE_ON:
+      return DEVICE_STATE_CHASE;
+    case CMD_RGB_OFF:
+    case CMD_RGB_RED:
+    case CMD_CAUTION_CYCLE:
+    case CMD_HAZARD_LEFT:
+    case CMD_HAZARD_RIGHT:
+    case CMD_HAZARD_CENTER:
+    case CMD_RGB_SOLID:
+    case CMD_RGB_RAINBOW:
+      return DEVICE_STATE_RGB;
+    case CMD_RGB_BRIGHTNESS:
+      return DEVICE_STATE_BRIGHTNESS;
+    default:
+      return 0;
+  }
+}
+
+// Forget what a command could have changed, for a command that may not have
+// arrived, such as one in a general call frame.  A general call is
+// acknowledged if any Nano answers, so it says nothing about any one of them.
+inline void deviceStateForgetCommand(DeviceState &state, byte pattern){
+  switch(pattern){
+    case CMD_RGB_POWER_OFF:
+    case CMD_RGB_POWER_ON:
+      state.known &= ~DEVICE_STATE_POWER;
+      state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+      break;
+    case CMD_ALL_OFF:
+      state.known &= ~(DEVICE_STATE_MAIN | DEVICE_STATE_CHASE);
+      state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+      break;
+    case CMD_MAIN_OFF:
+    case CMD_MAIN_ON:
+    case CMD_LEFT_MAIN_ON:
+    case CMD_RIGHT_MAIN_ON:
+      state.known &= ~DEVICE_STATE_MAIN;
+      break;
+    case CMD_LEFT_MAIN_OFF:
+      state.known &= ~DEVICE_STATE_MAIN_LEFT;
+      break;
+    case CMD_RIGHT_MAIN_OFF:
+      state.known &= ~DEVICE_STATE_MAIN_RIGHT;
+      break;
+    case CMD_CHASE_OFF:
+    case CMD_CHASE_ON:
+      state.known &= ~DEVICE_STATE_CHASE;
+      break;
+    case CMD_RGB_BRIGHTNESS:
+      state.known &= ~DEVICE_STATE_BRIGHTNESS;
+      break;
+    default: // Every other command only changes the RGB lights
+      state.rgbCommand = DEVICE_STATE_RGB_UNKNOWN;
+      break;
+  }
+}
+
+#endif
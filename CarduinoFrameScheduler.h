@@ -0,0 +1,139 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano 1, 2 and 3          *
+*    Description: Frame scheduler for the  *
+*                 light bar loop()         *
+*                                          *
+********************************************
+*/
+
+// Replaces the fixed delay(30) at the end of the Nano loop().  The loop
+// sleeps until the earliest of:
+//  - the next pattern deadline handed to wakeAt()
+//  - an incoming I2C message (notifyEvent() from the receive handler)
+//  - one frame period after the current frame started
+// The CPU idles in between and wakes on every interrupt (the millis() tick
+// or the TWI interrupt), so deadlines are met to within about 1 ms.
+
+#ifndef CARDUINO_FRAME_SCHEDULER_H
+#define CARDUINO_FRAME_SCHEDULER_H
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+
+#define FRAME_LATE_TOLERANCE 1 // Milliseconds a wake can be behind its deadline before it counts as late
+
+class FrameScheduler {
+  private:
+    unsigned int framePeriod;
+    unsigned long frameStartTime;
+    unsigned long requestedWakeTime;
+    boolean wakeRequested = false;
+    volatile boolean eventPending = false;
+
+    // Statistics
+    unsigned long frameCount = 0;
+    unsigned long overrunCount = 0;   // Frames whose work took longer than the frame period
+    unsigned long lateWakeCount = 0;  // Wakes that missed their deadline by more than FRAME_LATE_TOLERANCE
+    unsigned long longestFrame = 0;
+    HardwareSerial *reportSerial = NULL;
+
+  public:
+
+    // Constructor
+    FrameScheduler(byte targetFrameRate){
+      framePeriod = 1000 / targetFrameRate;
+    }
+
+    // Methods
+    void begin(){
+      frameStartTime = millis();
+    }
+
+    // Print a line on this port for every overrun and late wake
+    void reportOverruns(HardwareSerial &serial){
+      reportSerial = &serial;
+    }
+
+    // Wake no later than this time, for the next step of a running pattern
+    void wakeAt(unsigned long wakeTime){
+      if(!wakeRequested || (long)(wakeTime - requestedWakeTime) < 0){
+        requestedWakeTime = wakeTime;
+        wakeRequested = true;
+      }
+    }
+
+    // Called from interrupt context when there is new work, such as an I2C message
+    void notifyEvent(){
+      eventPending = true;
+    }
+
+    // Sleep until the next deadline, event or frame, then start the new frame
+    void waitForNextFrame(){
+      unsigned long frameTime = millis() - frameStartTime;
+
+      frameCount ++;
+      if(frameTime > longestFrame){
+        longestFrame = frameTime;
+      }
+      if(frameTime > framePeriod){
+        overrunCount ++;
+        if(reportSerial){
+          reportSerial->print(F("Frame overrun: "));
+          reportSerial->print(frameTime);
+          reportSerial->println(F(" ms"));
+        }
+      }
+
+      // Pick the earliest wake time
+      unsigned long wakeTime = frameStartTime + framePeriod;
+      if(wakeRequested && (long)(requestedWakeTime - wakeTime) < 0){
+        wakeTime = requestedWakeTime;
+      }
+      wakeRequested = false;
+
+      // Idle until an interrupt, then check again.  A message that lands just
+      // before sleep_mode() is picked up on the next millis() tick.
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      while(!eventPending && (long)(millis() - wakeTime) < 0){
+        sleep_mode();
+      }
+
+      unsigned long now = millis();
+      if(!eventPending && (long)(now - wakeTime) > FRAME_LATE_TOLERANCE){
+        lateWakeCount ++;
+        if(reportSerial){
+          reportSerial->print(F("Late wake: "));
+          reportSerial->print(now - wakeTime);
+          reportSerial->println(F(" ms"));
+        }
+      }
+
+      eventPending = false;
+      frameStartTime = now;
+    }
+
+    unsigned int checkFramePeriod(){
+      return framePeriod;
+    }
+
+    unsigned long checkFrameCount(){
+      return frameCount;
+    }
+
+    unsigned long checkOverrunCount(){
+      return overrunCount;
+    }
+
+    unsigned long checkLateWakeCount(){
+      return lateWakeCount;
+    }
+
+    unsigned long checkLongestFrame(){
+      return longestFrame;
+    }
+};
+
+#endif
@@ -0,0 +1,177 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Fixed rate switch        *
+*                 sampling from a timer    *
+*                 interrupt                *
+*                                          *
+********************************************
+*/
+
+// Samples the 74HC165 switch chain from a timer interrupt instead of from
+// loop(), so debounce time no longer depends on how long a pass of loop()
+// took.  The interrupt reads the chain, runs it through InputDebounce and,
+// when a debounced input changes, queues an InputEvent with the new state,
+// the inputs that changed and the millis() of the sample that confirmed the
+// change.  loop() takes the events with nextEvent(), and millis() minus the
+// event time is how long the change waited for loop() to get to it.
+//
+// On the AVR the sampler runs off Timer0's compare A interrupt, which fires
+// once per millis() tick (1024 us) alongside the overflow interrupt millis()
+// already uses, so no timer is taken away from anything else.  The
+// interrupt runs whichever sampler begin() was last called on.
+
+#ifndef CARDUINO_INPUT_SAMPLER_H
+#define CARDUINO_INPUT_SAMPLER_H
+
+#include <Arduino.h>
+#include "CarduinoDebounce.h"
+#include "CarduinoInputChain.h"
+
+#define INPUT_SAMPLE_PERIOD 1024 // Microseconds between samples, one Timer0 overflow
+#define INPUT_EVENT_QUEUE_SIZE 8 // Changes waiting for loop(), a power of 2
+
+template<byte WORDS>
+struct InputEvent {
+  uint32_t state[WORDS];   // Every debounced input after the change
+  uint32_t changed[WORDS]; // Inputs that changed
+  unsigned long time;      // millis() of the sample that confirmed the change
+};
+
+// The sampler the timer interrupt runs, set by begin()
+void (*inputSampleInterrupt)() = NULL;
+
+#ifdef __AVR__
+ISR(TIMER0_COMPA_vect){
+  if(inputSampleInterrupt){
+    inputSampleInterrupt();
+  }
+}
+#endif
+
+template<byte CHIPS>
+class InputSampler {
+  public:
+
+    static const byte words = InputChain<CHIPS>::words;
+    typedef InputEvent<InputChain<CHIPS>::words> Event;
+
+  private:
+
+    InputChain<CHIPS> &chain;
+    InputDebounce<InputChain<CHIPS>::words> &debounce;
+    Event events[INPUT_EVENT_QUEUE_SIZE];
+    volatile byte eventHead = 0; // Written only by the interrupt
+    volatile byte eventTail = 0; // Written only by loop()
+    volatile unsigned int droppedEvents = 0; // Changes that found the queue full and were merged into a later event
+    uint32_t pendingChanged[words] = {}; // Changes not queued yet, only used by the interrupt
+    boolean changesPending = false;
+    unsigned long pendingTime = 0;       // millis() of the first of them
+    volatile unsigned long samples = 0;
+
+    static InputSampler *running; // The sampler begin() was last called on
+
+    static void interrupt(){
+      running->sample();
+    }
+
+  public:
+
+    // Constructor
+    InputSampler(InputChain<CHIPS> &chain, InputDebounce<InputChain<CHIPS>::words> &debounce) : chain(chain), debounce(debounce){
+    }
+
+    // Methods
+    void begin(){
+      chain.begin();
+      running = this;
+      inputSampleInterrupt = interrupt;
+
+#ifdef __AVR__
+      OCR0A = 0x80; // Halfway through each Timer0 count, away from the millis() overflow
+      TIMSK0 |= _BV(OCIE0A);
+#else
+      hostAttachTimerInterrupt(INPUT_SAMPLE_PERIOD, interrupt);
+#endif
+    }
+
+    // Called from the timer interrupt
+    void sample(){
+      uint32_t inputs[words];
+      uint32_t changed[words];
+
+      chain.read(inputs);
+      samples ++;
+
+      boolean changedNow = debounce.update(inputs, changed);
+
+      if(changedNow){
+        if(!changesPending){
+          pendingTime = millis();
+          changesPending = true;
+        }
+        for(byte word = 0; word < words; word++){
+          pendingChanged[word] |= changed[word];
+        }
+      }
+
+      if(!changesPending){
+        return;
+      }
+
+      byte next = (eventHead + 1) & (INPUT_EVENT_QUEUE_SIZE - 1);
+      if(next == eventTail){
+        // loop() has fallen behind.  The changes stay pending and go into the
+        // next event that fits, with the state at that time, so loop() still
+        // hears about every input that changed.
+        if(changedNow){
+          droppedEvents ++;
+        }
+        return;
+      }
+
+      const uint32_t *state = debounce.checkState();
+      for(byte word = 0; word < words; word++){
+        events[eventHead].state[word] = state[word];
+        events[eventHead].changed[word] = pendingChanged[word];
+        pendingChanged[word] = 0;
+      }
+      events[eventHead].time = pendingTime;
+      eventHead = next;
+      changesPending = false;
+    }
+
+    // Take the oldest change.  Returns false if there is none.
+    boolean nextEvent(Event &event){
+      if(eventTail == eventHead){
+        return false;
+      }
+
+      event = events[eventTail];
+      eventTail = (eventTail + 1) & (INPUT_EVENT_QUEUE_SIZE - 1);
+
+      return true;
+    }
+
+    unsigned int checkDroppedEvents(){
+      noInterrupts();
+      unsigned int dropped = droppedEvents;
+      interrupts();
+      return dropped;
+    }
+
+    unsigned long checkSamples(){
+      noInterrupts();
+      unsigned long count = samples;
+      interrupts();
+      return count;
+    }
+
+};
+
+template<byte CHIPS>
+InputSampler<CHIPS> *InputSampler<CHIPS>::running = NULL;
+
+#endif
@@ -0,0 +1,1243 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano 1, 2 and 3          *
+*    Description: RGB light bar patterns   *
+*                                          *
+********************************************
+*/
+
+// One RGB light bar: a NeoPixel strip whose first LED is the main light
+// indicator and the rest the RGB ring.  The LED count is a template
+// parameter, so every length check and segment calculation in the patterns
+// is worked out by the compiler for the bar it is built for.  Pattern times
+// run on the sketch's sharedClock so every bar on the network steps together,
+// and each bar waits for its next step on a timer in patternTimers.
+//
+// The ring runs from LED 1 round the bar: the lower edge starts at
+// lowerRightCorner and the upper edge at upperLeftCorner, both width LEDs
+// long, with a corner LED at each end.  LightBarGeometry holds every segment
+// offset and length the patterns fill, worked out once per bar length.
+
+#ifndef CARDUINO_LIGHT_BAR_H
+#define CARDUINO_LIGHT_BAR_H
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include "CarduinoFrameScheduler.h"
+#include "CarduinoSync.h"
+#include "CarduinoTimerWheel.h"
+
+// Definitions
+#define PATTERN_CYCLE_TIME 5000
+#define FLASH_ON_TIME_SETTING 300
+#define FLASH_OFF_TIME_SETTING 20
+#define TARGET_FRAME_RATE 33 // Frames per second when no pattern step is due sooner, 33 matches the old delay(30) loop
+#define FRAME_TIME (1000 / TARGET_FRAME_RATE)
+#define PATTERN_TIMER_COUNT 4 // Light bars one board can run
+
+// Bar lengths, main light indicator included
+#define SIDE_BAR_NUM_LEDS 13
+#define BUMPER_BAR_NUM_LEDS 38
+#define MAIN_BAR_NUM_LEDS 83
+
+struct LightBarGeometry {
+  byte lowerRightCorner;     // First LED of the lower edge
+  byte upperLeftCorner;      // First LED of the upper edge
+  byte width;                // LEDs along each edge
+  byte lowerMidPoint;        // Middle of the lower edge
+  byte upperMidPoint;        // Middle of the upper edge
+  byte halfWidth;            // Half an edge, the middle LED included when there is one
+  byte leftWrap;             // Left half of the ring, lower midpoint round to upper midpoint
+  byte rightWraps;           // Each of the two runs making up the right half of the ring
+  byte aroundStepPixels[3];  // aroundTheWorld() LEDs added per step, by multiFlash
+  byte aroundStepTime[3];    // aroundTheWorld() time between steps, by multiFlash
+};
+
+// Segment calculations for a bar of numLeds LEDs.  An edge with an odd
+// number of LEDs has a middle LED, which the half segments take in; on the
+// 13 LED side bars the edges are even.
+constexpr byte lightBarUpperLeftCorner(byte numLeds){
+  return (numLeds - 1) / 2 + 2;
+}
+
+constexpr byte lightBarWidth(byte numLeds){
+  return (numLeds - 1) - lightBarUpperLeftCorner(numLeds);
+}
+
+constexpr byte lightBarMiddleLed(byte numLeds){
+  return lightBarWidth(numLeds) & 1;
+}
+
+// Short bars step one LED at a time and go faster for more flashes, the
+// bumper bar adds one LED per flash and the long bars two
+constexpr byte lightBarAroundStepPixels(byte numLeds, byte multiFlash){
+  return numLeds <= SIDE_BAR_NUM_LEDS ? 1 : numLeds <= BUMPER_BAR_NUM_LEDS ? multiFlash : multiFlash * 2;
+}
+
+constexpr byte lightBarAroundStepTime(byte numLeds, byte multiFlash){
+  return numLeds <= SIDE_BAR_NUM_LEDS ? (multiFlash == 1 ? 110 : multiFlash == 2 ? 55 : 33) : 30;
+}
+
+constexpr LightBarGeometry lightBarGeometry(byte numLeds){
+  return LightBarGeometry{
+    2,
+    lightBarUpperLeftCorner(numLeds),
+    lightBarWidth(numLeds),
+    (byte)(lightBarWidth(numLeds) / 2 + 2),
+    (byte)(lightBarUpperLeftCorner(numLeds) + lightBarWidth(numLeds) / 2),
+    (byte)(lightBarWidth(numLeds) / 2 + lightBarMiddleLed(numLeds)),
+    (byte)((numLeds - 1) / 2 + lightBarMiddleLed(numLeds)),
+    (byte)((numLeds - 1) / 4 + lightBarMiddleLed(numLeds)),
+    {lightBarAroundStepPixels(numLeds, 1), lightBarAroundStepPixels(numLeds, 2), lightBarAroundStepPixels(numLeds, 3)},
+    {lightBarAroundStepTime(numLeds, 1), lightBarAroundStepTime(numLeds, 2), lightBarAroundStepTime(numLeds, 3)}
+  };
+}
+
+// Network time and random seed from the Mega's sync frames, defined by the sketch
+extern SharedClock sharedClock;
+
+// Pattern step timers of every bar, ticked with sharedClock.now() once per
+// loop() pass and defined by the sketch
+typedef TimerWheel<PATTERN_TIMER_COUNT> PatternTimers;
+extern PatternTimers patternTimers;
+
+// Define named colors
+uint32_t white = Adafruit_NeoPixel::Color(255,255,255); // Daytime indicator hud state
+uint32_t red = Adafruit_NeoPixel::Color(255,0,0); // Nightime indicator hud state
+uint32_t green = Adafruit_NeoPixel::Color(0,255,0); // On indicator state
+uint32_t blue = Adafruit_NeoPixel::Color(0,0,255);
+uint32_t orange = Adafruit_NeoPixel::Color(255,80,0); // Auto indicator state
+uint32_t yellow = Adafruit_NeoPixel::Color(255,180,10);
+uint32_t purple = Adafruit_NeoPixel::Color(128,0,128);
+uint32_t off = Adafruit_NeoPixel::Color(0,0,0);
+
+template<byte NUM_LEDS>
+class RGBLightBar {
+  private:
+
+    // Strip that will be associated with this Light Bar
+    Adafruit_NeoPixel neopixelStrip;
+    // Variables
+    static const byte lastLedAddress = NUM_LEDS - 1; // LED 0 is the main light, the RGB ring is 1 to lastLedAddress
+    static constexpr LightBarGeometry geometry = lightBarGeometry(NUM_LEDS); // Segments of the ring
+    byte currentCautionPatternCall = random(2,7);
+    byte randomPatternFlair = random(1,3);
+    SharedRandom patternRandom; // Same picks on every bar once started from the shared seed
+    byte currentPatternLocal;
+    byte currentOverallState;
+    byte currentAdditionalStateOne;
+    byte numOfPatternCycles;
+    byte patternTimer;            // This bar's timer in patternTimers
+    uint16_t lastUpdateTime;      // Pattern tick of the last step
+    int flashOnTime;
+    byte flashCount;
+    long firstPixelHue;
+    boolean updateNeeded = false;
+    uint16_t nextUpdateTime;      // Earliest tick a pattern step is waiting for
+    boolean updateTimerSet = false;
+    uint16_t dueTime;             // When the step updateDue() last let through was due
+    boolean dueTimeReached = false;
+
+    // Check if waitTime has passed since the last update.  If not, remember
+    // when it will so the frame scheduler can wake up for it.  Ticks are on
+    // the shared network clock so every bar steps at the same moment.
+    boolean updateDue(unsigned int waitTime){
+      uint16_t stepTime = lastUpdateTime + waitTime;
+
+      patternTimers.startAt(patternTimer, stepTime);
+      if(patternTimers.checkExpired(patternTimer)){
+        dueTime = stepTime;
+        dueTimeReached = true;
+        return true;
+      }
+
+      if(!updateTimerSet || (int16_t)(stepTime - nextUpdateTime) < 0){
+        nextUpdateTime = stepTime;
+        updateTimerSet = true;
+      }
+
+      return false;
+    }
+
+    // Mark the time of a pattern step.  A step that ran within a frame of
+    // when it was due counts from the due time, so wake-up jitter does not
+    // pile up and push the bars out of step with each other.
+    void markUpdateTime(){
+      uint16_t now = patternTimers.checkTick();
+
+      if(dueTimeReached && (uint16_t)(now - dueTime) < FRAME_TIME){
+        lastUpdateTime = dueTime;
+      } else {
+        lastUpdateTime = now;
+      }
+      dueTimeReached = false;
+    }
+
+  public:
+
+    // Constructor - the data pin is set in begin()
+    RGBLightBar() : neopixelStrip(NUM_LEDS){
+    }
+
+    // Methods
+    void begin(byte dataPin, byte brightness){
+      patternTimer = patternTimers.addTimer();
+      neopixelStrip.setPin(dataPin);
+      neopixelStrip.setBrightness(brightness);
+      neopixelStrip.begin();
+    }
+
+    void setBrightness(byte brightness){
+      neopixelStrip.setBrightness(brightness);
+
+      updateNeeded = true; // Activate update flag
+    }
+
+    void mainLightOn(){
+      neopixelStrip.setPixelColor(0,red);
+
+      updateNeeded = true; // Activate update flag
+    }
+
+    void mainLightOff(){
+      neopixelStrip.setPixelColor(0,green);
+
+      updateNeeded = true; // Activate update flag
+    }
+
+    void solidColor(uint32_t color){
+      neopixelStrip.fill(color,1,lastLedAddress);
+
+      updateNeeded = true; // Activate update flag
+    }
+
+    // Restart the caution cycle from a seed, so bars given the same seed run the same sequence
+    void startCautionPatternCycle(byte seed){
+      patternRandom.seed(seed);
+      currentCautionPatternCall = patternRandom.next(2,7);
+      randomPatternFlair = patternRandom.next(1,3);
+      currentPatternLocal = 0; // Start the first pattern from its beginning
+    }
+
+    void cautionPatternCycle(){
+      
+      if(currentCautionPatternCall == 8){
+        currentCautionPatternCall = 2;
+      } else if(currentCautionPatternCall > 8){
+        currentCautionPatternCall = 3;
+      }
+
+      switch(currentCautionPatternCall){
+        case 2:
+          if(flashFull(randomPatternFlair,yellow,white,yellow,10)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+
+        case 3:
+          if(upAndDown(randomPatternFlair,yellow,white,yellow,10)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+
+        case 4:
+          if(leftAndRight(randomPatternFlair,yellow,white,yellow,10)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+
+        case 5:
+          if(crissCross(randomPatternFlair,yellow,white,yellow,10)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+
+        case 6:
+          if(everyOther(randomPatternFlair,yellow,white,yellow,10)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+
+        case 7:
+          if(aroundTheWorld(randomPatternFlair,yellow,white,yellow,7)){
+            currentCautionPatternCall = currentCautionPatternCall + patternRandom.next(1,3);
+            randomPatternFlair = patternRandom.next(1,4);
+          }
+
+          break;
+      }
+    }
+
+    // Rainbow cycle along whole strip. Pass speed 0 = Full Speed | 1 = Fast | 2 = Moderate | 3 = Slow
+    void rainbow(int wait) {
+
+      // Full Speed is one step every frame
+      unsigned int stepTime = wait * 10;
+      if(stepTime < FRAME_TIME){
+        stepTime = FRAME_TIME;
+      }
+
+      // Check if this pattern has just been activated - Pattern #4
+      if(currentPatternLocal != 1){
+        currentPatternLocal = 1; // Set to new current patern
+        firstPixelHue = 0; // Reset state to initial value
+        lastUpdateTime = patternTimers.checkTick() - stepTime; // Set lastUpdateTime so code will run first time
+      }
+
+      if(updateDue(stepTime)){
+        // Reset pixel hue if we have gone over the amount
+        if(firstPixelHue > 5*65536){
+          firstPixelHue = 0;
+        }
+
+        // Fill light with the current ranbow patern
+        for(int i=1; i<NUM_LEDS; i++) { // For each pixel in strip...
+          // Offset pixel hue by an amount to make one full revolution of the
+          // color wheel (range of 65536) along the length of the strip
+          // (strip.numPixels() steps):
+          int pixelHue = firstPixelHue + (i * 65536L / NUM_LEDS);
+          // neopixelStrip.ColorHSV() can take 1 or 3 arguments: a hue (0 to 65535) or
+          // optionally add saturation and value (brightness) (each 0 to 255).
+          // Here we're using just the single-argument hue variant. The result
+          // is passed through neopixelStrip.gamma32() to provide 'truer' colors
+          // before assigning to each pixel:
+          neopixelStrip.setPixelColor(i, neopixelStrip.gamma32(neopixelStrip.ColorHSV(pixelHue)));
+        }
+
+        // Incrament Hue value
+        firstPixelHue += 256;
+
+        // Set last update time
+        markUpdateTime();
+
+        updateNeeded = true; // Activate update flag
+      }
+    }
+
+    // Flash pattern - whole strip - 2
+    boolean flashFull(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time
+      if(multiFlash > 1){
+        flashOnTime = (FLASH_ON_TIME_SETTING / multiFlash) - (FLASH_OFF_TIME_SETTING * multiFlash);
+      } else {
+        flashOnTime = FLASH_ON_TIME_SETTING;
+      }
+
+
+      // Check if this pattern has just been activated - Pattern #2
+      if(currentPatternLocal != 2){
+        currentPatternLocal = 2; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+        case 0: // Reset to initial ON state
+          neopixelStrip.fill(colorOne,1,lastLedAddress); // Set the color
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 0; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Change to OFF state
+          if(updateDue(flashOnTime)){
+            neopixelStrip.fill(off,1,lastLedAddress); // Turn off strip
+            markUpdateTime(); // Mark the update time
+            currentOverallState = 2; // Update State
+            flashCount ++; // Incrament flash count
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Loop back to ON state
+          if(flashCount == multiFlash){
+            // Wait for full time if we have flashed the proper amount of times.
+            if(updateDue(FLASH_ON_TIME_SETTING)){
+              neopixelStrip.fill(colorOne,1,lastLedAddress); // Set the color
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 1; // Update State
+              flashCount = 0; //update flash count
+              numOfPatternCycles ++; // Incrament pattern cycle count
+              updateNeeded = true; // Activate update flag
+            }
+          } else {
+            if(updateDue(FLASH_OFF_TIME_SETTING)){
+              if(flashCount == 1 and colorTwo != off){
+                neopixelStrip.fill(colorTwo,1,lastLedAddress); // Set the color
+              } else if(flashCount == 2 and colorThree != off){
+                neopixelStrip.fill(colorThree,1,lastLedAddress); // Set the color
+              } else {
+                neopixelStrip.fill(colorOne,1,lastLedAddress); // Set the color
+              }
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 1; // Update State
+              updateNeeded = true; // Activate update flag
+            }
+          }
+          break;
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+    }
+
+    // Flash pattern - top strip then bottom strip - 3
+    boolean upAndDown(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time
+      if(multiFlash > 1){
+        flashOnTime = (FLASH_ON_TIME_SETTING / multiFlash) - (FLASH_OFF_TIME_SETTING * multiFlash);
+      } else {
+        flashOnTime = FLASH_ON_TIME_SETTING;
+      }
+
+      // Check if this pattern has just been activated - Pattern #3
+      if(currentPatternLocal != 3){
+        currentPatternLocal = 3; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+
+        case 0: // Reset to initial UP ON state
+          neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+          neopixelStrip.fill(colorOne,geometry.upperLeftCorner, geometry.width) ; // turn on upper light
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 0; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Change to either UP OFF or DOWN ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,geometry.upperLeftCorner,geometry.width); // turn off upper light
+              currentOverallState = 2; // Update State
+            } else {
+              neopixelStrip.fill(colorOne,geometry.lowerRightCorner,geometry.width); // Set lowwer color
+              neopixelStrip.fill(off,geometry.upperLeftCorner,geometry.width); // Set Upper color
+              currentOverallState = 3; // Update State
+              flashCount = 0; // reset flash counter
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Change to UP ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,geometry.upperLeftCorner,geometry.width); // Set the color
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,geometry.upperLeftCorner,geometry.width); // Set the color
+            } else {
+              neopixelStrip.fill(colorOne,geometry.upperLeftCorner,geometry.width); // Set the color
+            }
+            currentOverallState = 1; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 3: // Change to either DOWN OFF or UP ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,geometry.lowerRightCorner,geometry.width); // turn off lower light
+              currentOverallState = 4; // Update State
+            } else {
+              neopixelStrip.fill(colorOne,geometry.upperLeftCorner,geometry.width); // Set upper color
+              neopixelStrip.fill(off,geometry.lowerRightCorner,geometry.width); // Set lower color
+              currentOverallState = 1; // Update State
+              flashCount = 0; // reset flash counter
+              numOfPatternCycles ++; // Incrament pattern cycle count
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 4: // Change to DOWN ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,geometry.lowerRightCorner,geometry.width); // Set the color
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,geometry.lowerRightCorner,geometry.width); // Set the color
+            } else {
+              neopixelStrip.fill(colorOne,geometry.lowerRightCorner,geometry.width); // Set the color
+            }
+            currentOverallState = 3; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+
+    }
+
+    // Flash pattern - Left side then Right side - 4
+    boolean leftAndRight(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time
+      if(multiFlash > 1){
+        flashOnTime = (FLASH_ON_TIME_SETTING / multiFlash) - (FLASH_OFF_TIME_SETTING * multiFlash);
+      } else {
+        flashOnTime = FLASH_ON_TIME_SETTING;
+      }
+
+      // Check if this pattern has just been activated - Pattern #4
+      if(currentPatternLocal != 4){
+        currentPatternLocal = 4; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+
+        case 0: // Reset to initial LEFT ON state
+          neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+          neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.leftWrap); // turn on LEFT light
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 0; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Change to either LEFT OFF or RIGHT ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,geometry.lowerMidPoint,geometry.leftWrap); // turn off LEFT light
+              currentOverallState = 2; // Update State
+            } else {
+              neopixelStrip.fill(off,geometry.lowerMidPoint,geometry.leftWrap); // Set Left color
+              neopixelStrip.fill(colorOne,1,geometry.rightWraps); // Set lowwer RIGHT color
+              neopixelStrip.fill(colorOne,geometry.upperMidPoint,geometry.rightWraps); // Set Upper RIGHT color
+              currentOverallState = 3; // Update State
+              flashCount = 0; // reset flash counter
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Change to LEFT ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,geometry.lowerMidPoint,geometry.leftWrap); // Set the color
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,geometry.lowerMidPoint,geometry.leftWrap); // Set the color
+            } else {
+              neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.leftWrap); // Set the color
+            }
+            currentOverallState = 1; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 3: // Change to either RIGHT OFF or LEFT ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,1,geometry.rightWraps); // turn off lower RIGHT light
+              neopixelStrip.fill(off,geometry.upperMidPoint,geometry.rightWraps); // turn off Upper RIGHT light
+              currentOverallState = 4; // Update State
+            } else {
+              neopixelStrip.fill(off,1,geometry.rightWraps); // turn off lower RIGHT light
+              neopixelStrip.fill(off,geometry.upperMidPoint,geometry.rightWraps); // turn off Upper RIGHT light
+              neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.leftWrap); // Set upper color
+              currentOverallState = 1; // Update State
+              flashCount = 0; // reset flash counter
+              numOfPatternCycles ++; // Incrament pattern cycle count
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 4: // Change to RIGHT ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,1,geometry.rightWraps); // turn off lower RIGHT light
+              neopixelStrip.fill(colorTwo,geometry.upperMidPoint,geometry.rightWraps); // turn off Upper RIGHT light
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,1,geometry.rightWraps); // turn off lower RIGHT light
+              neopixelStrip.fill(colorThree,geometry.upperMidPoint,geometry.rightWraps); // turn off Upper RIGHT light
+            } else {
+              neopixelStrip.fill(colorOne,1,geometry.rightWraps); // turn off lower RIGHT light
+              neopixelStrip.fill(colorOne,geometry.upperMidPoint,geometry.rightWraps); // turn off Upper RIGHT light
+            }
+            currentOverallState = 3; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+
+    }
+
+    // Flash pattern - kiddy corner to each other - 5
+    boolean crissCross(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time
+      if(multiFlash > 1){
+        flashOnTime = (FLASH_ON_TIME_SETTING / multiFlash) - (FLASH_OFF_TIME_SETTING * multiFlash);
+      } else {
+        flashOnTime = FLASH_ON_TIME_SETTING;
+      }
+
+      // Check if this pattern has just been activated - Pattern #5
+      if(currentPatternLocal != 5){
+        currentPatternLocal = 5; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+
+        case 0: // Reset to initial UP RIGHT/DOWN LEFT ON state
+          neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+          neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.halfWidth); // turn ON lower left light
+          neopixelStrip.fill(colorOne,geometry.upperMidPoint,geometry.halfWidth); // turn ON upper right light
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 0; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Change to either UP RIGHT/DOWN LEFT OFF or UP LEFT/DOWN RIGHT ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+              currentOverallState = 2; // Update State
+            } else {
+              neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+              neopixelStrip.fill(colorOne,geometry.lowerRightCorner,geometry.halfWidth); // turn ON lower right light
+              neopixelStrip.fill(colorOne,geometry.upperLeftCorner,geometry.halfWidth); // turn ON upper left light
+              currentOverallState = 3; // Update State
+              flashCount = 0; // reset flash counter
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Change to UP RIGHT/DOWN LEFT ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,geometry.lowerMidPoint,geometry.halfWidth); // turn ON lower left light with 2nd color
+              neopixelStrip.fill(colorTwo,geometry.upperMidPoint,geometry.halfWidth); // turn ON upper right light with 2nd color
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,geometry.lowerMidPoint,geometry.halfWidth); // turn ON lower left light with 3rd color
+              neopixelStrip.fill(colorThree,geometry.upperMidPoint,geometry.halfWidth); // turn ON upper right light with 3rd color
+            } else {
+              neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.halfWidth); // turn ON lower left light with 1st color
+              neopixelStrip.fill(colorOne,geometry.upperMidPoint,geometry.halfWidth); // turn ON upper right light with 1st color
+            }
+            currentOverallState = 1; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 3: // Change to either UP LEFT/DOWN RIGHT OFF or UP RIGHT/DOWN LEFT ON state
+          if(updateDue(flashOnTime)){
+            flashCount ++; // Incrament flash count
+            if(multiFlash > 1 and multiFlash != flashCount){
+              neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+              currentOverallState = 4; // Update State
+            } else {
+              neopixelStrip.fill(off,1,lastLedAddress); // clear all values
+              neopixelStrip.fill(colorOne,geometry.lowerMidPoint,geometry.halfWidth); // turn ON lower left light
+              neopixelStrip.fill(colorOne,geometry.upperMidPoint,geometry.halfWidth); // turn ON upper right ligt
+              currentOverallState = 1; // Update State
+              flashCount = 0; // reset flash counter
+              numOfPatternCycles ++; // Incrament pattern cycle count
+            }
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 4: // Change to UP LEFT/DOWN RIGHT ON state
+          if(updateDue(FLASH_OFF_TIME_SETTING)){
+            if(flashCount == 1 and colorTwo != off){
+              neopixelStrip.fill(colorTwo,geometry.lowerRightCorner,geometry.halfWidth); // turn ON lower right light with 2nd color
+              neopixelStrip.fill(colorTwo,geometry.upperLeftCorner,geometry.halfWidth); // turn ON upper left light with 2nd color
+            } else if(flashCount == 2 and colorThree != off){
+              neopixelStrip.fill(colorThree,geometry.lowerRightCorner,geometry.halfWidth); // turn ON lower right light with 3rd color
+              neopixelStrip.fill(colorThree,geometry.upperLeftCorner,geometry.halfWidth); // turn ON upper left light with 3rd color
+            } else {
+              neopixelStrip.fill(colorOne,geometry.lowerRightCorner,geometry.halfWidth); // turn ON lower right light with 1st color
+              neopixelStrip.fill(colorOne,geometry.upperLeftCorner,geometry.halfWidth); // turn ON upper left light with 1st color
+            }
+            currentOverallState = 3; // Update State
+            markUpdateTime(); // Mark the update time
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+
+    }
+
+    // Flash pattern - Every other light - 6
+    boolean everyOther(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time
+      if(multiFlash > 1){
+        flashOnTime = (FLASH_ON_TIME_SETTING / multiFlash) - (FLASH_OFF_TIME_SETTING * multiFlash);
+      } else {
+        flashOnTime = FLASH_ON_TIME_SETTING;
+      }
+
+
+      // Check if this pattern has just been activated - Pattern #6
+      if(currentPatternLocal != 6){
+        currentPatternLocal = 6; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+        case 0: // Reset to initial ON state - Odd #pixels
+          for(int i=1; i<NUM_LEDS; i++){
+            if(i % 2 == 0){ // Even pixels OFF
+              neopixelStrip.setPixelColor(i, off);
+            } else { // Odd pixels color #1
+              neopixelStrip.setPixelColor(i, colorOne);
+            }
+          }
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 0; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Change to OFF state #1
+          if(updateDue(flashOnTime)){
+            neopixelStrip.fill(off,1,lastLedAddress); // Turn off strip
+            markUpdateTime(); // Mark the update time
+            currentOverallState = 2; // Update State
+            flashCount ++; // Incrament flash count
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Loop back to ON state
+          if(flashCount == multiFlash){
+            // Wait for full time if we have flashed the proper amount of times.
+            if(updateDue(FLASH_ON_TIME_SETTING)){
+              for(int i=1; i<NUM_LEDS; i++){
+                if(i % 2 == 0){ // Even pixels Color #1
+                  neopixelStrip.setPixelColor(i, colorOne);
+                } else { // Odd pixels OFF
+                  neopixelStrip.setPixelColor(i, off);
+                }
+              }
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 3; // Update State
+              flashCount = 0; //update flash count
+              updateNeeded = true; // Activate update flag
+            }
+          } else {
+            if(updateDue(FLASH_OFF_TIME_SETTING)){
+              if(flashCount == 1 and colorTwo != off){
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  } else { // Odd pixels color #1
+                    neopixelStrip.setPixelColor(i, colorTwo);
+                  }
+                }
+              } else if(flashCount == 2 and colorThree != off){
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  } else { // Odd pixels color #1
+                    neopixelStrip.setPixelColor(i, colorThree);
+                  }
+                }
+              } else {
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  } else { // Odd pixels color #1
+                    neopixelStrip.setPixelColor(i, colorOne);
+                  }
+                }
+              }
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 1; // Update State
+              updateNeeded = true; // Activate update flag
+            }
+          }
+          break;
+
+        case 3: // Change to OFF state #2
+          if(updateDue(flashOnTime)){
+            neopixelStrip.fill(off,1,lastLedAddress); // Turn off strip
+            markUpdateTime(); // Mark the update time
+            currentOverallState = 4; // Update State
+            flashCount ++; // Incrament flash count
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 4: // Loop back to ON state
+          if(flashCount == multiFlash){
+            // Wait for full time if we have flashed the proper amount of times.
+            if(updateDue(FLASH_ON_TIME_SETTING)){
+              for(int i=1; i<NUM_LEDS; i++){
+                if(i % 2 == 0){ // Even pixels OFF
+                  neopixelStrip.setPixelColor(i, off);
+                } else { // Odd pixels color #1
+                  neopixelStrip.setPixelColor(i, colorOne);
+                }
+              }
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 1; // Update State
+              flashCount = 0; //update flash count
+              numOfPatternCycles ++; // Incrament pattern cycle count
+              updateNeeded = true; // Activate update flag
+            }
+          } else {
+            if(updateDue(FLASH_OFF_TIME_SETTING)){
+              if(flashCount == 1 and colorTwo != off){
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels Color #2
+                    neopixelStrip.setPixelColor(i, colorTwo);
+                  } else { // Odd pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  }
+                }
+              } else if(flashCount == 2 and colorThree != off){
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels Color #3
+                    neopixelStrip.setPixelColor(i, colorThree);
+                  } else { // Odd pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  }
+                }
+              } else {
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i % 2 == 0){ // Even pixels Color #1
+                    neopixelStrip.setPixelColor(i, colorOne);
+                  } else { // Odd pixels OFF
+                    neopixelStrip.setPixelColor(i, off);
+                  }
+                }
+              }
+              markUpdateTime(); // Mark the update time
+              currentOverallState = 3; // Update State
+              updateNeeded = true; // Activate update flag
+            }
+          }
+          break;
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+    }
+
+    // Flash pattern - Around the world - 7
+    boolean aroundTheWorld(byte multiFlash, uint32_t colorOne, uint32_t colorTwo = off, uint32_t colorThree = off, byte patternCyclesToRun = 1){
+
+      // Caculate actual flash time - This variable is used differently than the other patterns.  This is time between pixel additions
+      flashOnTime = geometry.aroundStepTime[multiFlash - 1];
+      
+      if(colorOne == colorThree && multiFlash == 3){ // This pattern only works with 3 colors when the colors are different.
+        multiFlash = 2;
+      }
+
+      // Check if this pattern has just been activated - Pattern #7
+      if(currentPatternLocal != 7){
+        currentPatternLocal = 7; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+
+        currentAdditionalStateOne = geometry.aroundStepPixels[multiFlash - 1]; // Used to keep track of which light we are turning on next
+
+        numOfPatternCycles = 0; // Reset number of pattern cycles
+      }
+
+      switch(currentOverallState){
+        case 0: // Reset to initial ON state - 1st pixel
+          for(int i=1; i<NUM_LEDS; i++){
+            if(i <= currentAdditionalStateOne){ // Turn on the first pixel
+              neopixelStrip.setPixelColor(i, colorOne);
+            } else { // Turn off all the rest
+              neopixelStrip.setPixelColor(i, off);
+            }
+          }
+          markUpdateTime(); // Mark the update time
+          currentOverallState = 1; // Update State
+          flashCount = 1; //update flash count
+          updateNeeded = true; // Activate update flag
+          break;
+
+        case 1: // Continue to fill the whole bar with Color
+          if(updateDue(flashOnTime)){
+            for(int i=1; i<NUM_LEDS; i++){
+              if(i <= currentAdditionalStateOne){ // Turn on the first pixel
+                switch(flashCount){
+                  case 1:
+                    neopixelStrip.setPixelColor(i, colorOne);
+                    break;
+
+                  case 2:
+                    neopixelStrip.setPixelColor(i, colorTwo);
+                    break;
+
+                  case 3:
+                    neopixelStrip.setPixelColor(i, colorThree);
+                    break;
+                } 
+              } else { // Turn off all the rest
+                neopixelStrip.setPixelColor(i, off);
+              }
+            }
+            
+            markUpdateTime(); // Mark the update time
+            
+            currentAdditionalStateOne = currentAdditionalStateOne + geometry.aroundStepPixels[multiFlash - 1]; // Incrememnt to next light
+            
+            if(currentAdditionalStateOne >=  NUM_LEDS){
+              currentOverallState = 2; // Update State
+
+              currentAdditionalStateOne = geometry.aroundStepPixels[multiFlash - 1]; // Reset additional state
+
+            }
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+
+        case 2: // Turn pixels off one at a time
+          if(updateDue(flashOnTime)){
+            for(int i=1; i<NUM_LEDS; i++){
+              if(i <= currentAdditionalStateOne){
+                neopixelStrip.setPixelColor(i, off);
+              } else { // Turn off all the rest
+                switch(flashCount){
+                  case 1:
+                    neopixelStrip.setPixelColor(i, colorOne);
+                    break;
+
+                  case 2:
+                    neopixelStrip.setPixelColor(i, colorTwo);
+                    break;
+
+                  case 3:
+                    neopixelStrip.setPixelColor(i, colorThree);
+                    break;
+                } 
+              }
+            }
+            
+            markUpdateTime(); // Mark the update time
+
+            currentAdditionalStateOne = currentAdditionalStateOne + geometry.aroundStepPixels[multiFlash - 1]; // Incrememnt to next light
+
+            if(currentAdditionalStateOne >=  NUM_LEDS){
+              currentOverallState = 1; // Update State
+              flashCount ++;
+              if(flashCount > multiFlash){ 
+                flashCount = 1;
+              }
+
+              currentAdditionalStateOne = geometry.aroundStepPixels[multiFlash - 1]; // Reset additional state
+
+              numOfPatternCycles ++; 
+            }
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+      }
+
+      if(numOfPatternCycles == patternCyclesToRun){
+        return true; // Return True when we have run the requested amount of pattern cycles
+      } else {
+        return false;
+      }
+    }
+
+    
+    
+    // Flash pattern - Hazard - 30 - Meant for rear bar only - Left 1 | Center 0 | Right 2
+    void hazardPatternRearBar(byte direction){
+
+      // Define method variables
+      byte firstPixel;
+      byte secondPixel;
+      byte thirdPixel;
+      byte lastPixel;
+      
+      // Declare pattern arrays
+      byte toLeftArray[13][2] = { {38,45},
+                                  {35,48},
+                                  {32,51},
+                                  {29,54},
+                                  {26,57},
+                                  {23,60},
+                                  {20,63},
+                                  {17,66},
+                                  {14,69},
+                                  {11,72},
+                                  {8,75},
+                                  {5,78},
+                                  {1,82} };
+                        
+      byte toRightArray[13][2] = { {4,79},
+                                   {7,76},
+                                   {10,73},
+                                   {13,70},
+                                   {16,67},
+                                   {19,64},
+                                   {22,61},
+                                   {25,58},
+                                   {28,55},
+                                   {31,52},
+                                   {34,49},
+                                   {37,46},
+                                   {41,42} };
+                              
+      byte centerArray[10][4] = { {20,22,61,63},
+                                  {18,24,59,65},
+                                  {16,26,57,67},
+                                  {14,28,55,69},
+                                  {12,30,53,71},
+                                  {10,32,51,73},
+                                  {8,34,49,75},
+                                  {6,36,47,77},
+                                  {4,38,45,79},
+                                  {1,41,42,82} };
+
+      // Assign timing
+      flashOnTime = FLASH_ON_TIME_SETTING / 2;
+      
+      // Check if this pattern has just been activated - Pattern #30
+      if(currentPatternLocal != 30){
+        currentPatternLocal = 30; // Set to new current patern
+        currentOverallState = 0; // Reset state to initial value
+        currentAdditionalStateOne = 0;
+        lastUpdateTime = patternTimers.checkTick() - flashOnTime; // Set lastUpdateTime so code will run first time
+      }
+
+      switch(currentOverallState){
+        case 0: // Fill bar in specified direction
+          if(updateDue(flashOnTime)){
+            switch(direction){
+              case 1: // Left
+                  
+                // Assign first and last pixels to turn on
+                firstPixel = toLeftArray[currentAdditionalStateOne][0];
+                lastPixel = toLeftArray[currentAdditionalStateOne][1];
+                
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i >= firstPixel && i <= lastPixel){ // Continue filling to the left
+                    neopixelStrip.setPixelColor(i, yellow);
+                  } else {
+                    neopixelStrip.setPixelColor(i, off);
+                  }
+                }
+                break;
+
+              case 0: // Center
+                // Assign first and last pixels to turn on
+                firstPixel = centerArray[currentAdditionalStateOne][0];
+                secondPixel = centerArray[currentAdditionalStateOne][1];
+                thirdPixel = centerArray[currentAdditionalStateOne][2];
+                lastPixel = centerArray[currentAdditionalStateOne][3];
+                
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i >= firstPixel && i <= secondPixel || i >= thirdPixel && i <= lastPixel){ // Continue filling to the left
+                    neopixelStrip.setPixelColor(i, yellow);
+                  } else {
+                    neopixelStrip.setPixelColor(i, off);
+                  }
+                }
+                break;
+
+              case 2: // Right
+                // Assign first and last pixels to turn on
+                  firstPixel = toRightArray[currentAdditionalStateOne][0];
+                  lastPixel = toRightArray[currentAdditionalStateOne][1];
+                  
+                  for(int i=1; i<NUM_LEDS; i++){
+                    if(i <= firstPixel || i >= lastPixel){ // Continue filling to the right
+                      neopixelStrip.setPixelColor(i, yellow);
+                    } else {
+                      neopixelStrip.setPixelColor(i, off);
+                    }
+                  }
+                break;
+            }
+
+            markUpdateTime(); // Mark the update time
+            currentAdditionalStateOne ++;
+
+            if(direction == 0){
+              if(currentAdditionalStateOne > 9){
+                currentAdditionalStateOne = 0;
+                currentOverallState = 1; // Update State
+              }
+            } else {
+              if(currentAdditionalStateOne > 12){
+                currentAdditionalStateOne = 0;
+                currentOverallState = 1; // Update State
+              }
+            }
+            updateNeeded = true; // Activate update flag
+          }
+
+          break;
+
+        case 1: // turn bar off
+          if(updateDue(flashOnTime)){
+            switch(direction){
+              case 1: // Left
+                  
+                  // Assign first and last pixels to turn on
+                  firstPixel = toLeftArray[currentAdditionalStateOne][0];
+                  lastPixel = toLeftArray[currentAdditionalStateOne][1];
+                  
+                  for(int i=1; i<NUM_LEDS; i++){
+                    if(i >= firstPixel && i <= lastPixel){ // Continue filling to the left
+                      neopixelStrip.setPixelColor(i, off);
+                    } else {
+                      neopixelStrip.setPixelColor(i, yellow);
+                    }
+                  }
+                break;
+
+              case 0: // Center
+                // Assign first and last pixels to turn on
+                firstPixel = centerArray[currentAdditionalStateOne][0];
+                secondPixel = centerArray[currentAdditionalStateOne][1];
+                thirdPixel = centerArray[currentAdditionalStateOne][2];
+                lastPixel = centerArray[currentAdditionalStateOne][3];
+                
+                for(int i=1; i<NUM_LEDS; i++){
+                  if(i >= firstPixel && i <= secondPixel || i >= thirdPixel && i <= lastPixel){ // Continue filling to the left
+                    neopixelStrip.setPixelColor(i, off);
+                  } else {
+                    neopixelStrip.setPixelColor(i, yellow);
+                  }
+                }
+                break;
+
+              case 2: // Right
+                // Assign first and last pixels to turn on
+                  firstPixel = toRightArray[currentAdditionalStateOne][0];
+                  lastPixel = toRightArray[currentAdditionalStateOne][1];
+                  
+                  for(int i=1; i<NUM_LEDS; i++){
+                    if(i <= firstPixel || i >= lastPixel){ // Continue filling to the right
+                      neopixelStrip.setPixelColor(i, off);
+                    } else {
+                      neopixelStrip.setPixelColor(i, yellow);
+                    }
+                  }
+                break;
+            }
+
+            markUpdateTime(); // Mark the update time
+            currentAdditionalStateOne ++;
+
+            if(direction == 0){
+              if(currentAdditionalStateOne > 9){
+                currentAdditionalStateOne = 0;
+                currentOverallState = 0; // Update State
+              }
+            } else {
+              if(currentAdditionalStateOne > 12){
+                currentAdditionalStateOne = 0;
+                currentOverallState = 0; // Update State
+              }
+            }
+            updateNeeded = true; // Activate update flag
+          }
+          break;
+      }
+    }
+    
+    
+    // Run the show() function on the strip if updates are required
+    void runUpdates(){
+
+      // Check if an update is needed
+      if (updateNeeded){
+        neopixelStrip.show(); // Run show() on the strip
+        updateNeeded = !updateNeeded; // reset back to false
+
+        // A pattern only sets its next timer on the pass after a step, so come straight back
+        nextUpdateTime = patternTimers.checkTick();
+        updateTimerSet = true;
+      }
+    }
+
+    // Tell the frame scheduler when the running pattern needs to run next
+    void scheduleNextUpdate(FrameScheduler &frameScheduler){
+      if(updateTimerSet){
+        frameScheduler.wakeAt(sharedClock.localTime(patternTimers.checkTime(nextUpdateTime)));
+        updateTimerSet = false;
+      }
+    }
+
+};
+
+template<byte NUM_LEDS>
+constexpr LightBarGeometry RGBLightBar<NUM_LEDS>::geometry;
+
+// The side and main bar segments the patterns were first written against
+static_assert(lightBarGeometry(SIDE_BAR_NUM_LEDS).upperLeftCorner == 8 && lightBarGeometry(SIDE_BAR_NUM_LEDS).width == 4 &&
+              lightBarGeometry(SIDE_BAR_NUM_LEDS).halfWidth == 2 && lightBarGeometry(SIDE_BAR_NUM_LEDS).leftWrap == 6 &&
+              lightBarGeometry(SIDE_BAR_NUM_LEDS).rightWraps == 3, "Side bar segments changed");
+static_assert(lightBarGeometry(MAIN_BAR_NUM_LEDS).upperLeftCorner == 43 && lightBarGeometry(MAIN_BAR_NUM_LEDS).width == 39 &&
+              lightBarGeometry(MAIN_BAR_NUM_LEDS).halfWidth == 20 && lightBarGeometry(MAIN_BAR_NUM_LEDS).leftWrap == 42 &&
+              lightBarGeometry(MAIN_BAR_NUM_LEDS).rightWraps == 21, "Main bar segments changed");
+
+#endif
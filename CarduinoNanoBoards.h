@@ -0,0 +1,96 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano 1, 2 and 3          *
+*    Description: Board profiles for the   *
+*                 shared Nano firmware     *
+*                                          *
+********************************************
+*/
+
+// Everything that makes one Nano different from another.  Every Nano runs
+// the same firmware (CarduinoNanoFirmware.h); its sketch only picks one of
+// these profiles.  The profiles are constexpr, so the strip length, pin
+// numbers and the commands a board answers are all fixed at compile time and
+// code for hardware a board does not have is left out.
+
+#ifndef CARDUINO_NANO_BOARDS_H
+#define CARDUINO_NANO_BOARDS_H
+
+#include <Arduino.h>
+#include "CarduinoCommands.h"
+#include "CarduinoLightBar.h"
+#include "CarduinoProtocol.h"
+
+#define NO_PIN 255       // The board does not have this output
+#define MAX_STRIPS 4
+
+// Which side of the vehicle a strip is on, for the left/right commands
+#define SIDE_LEFT 1
+#define SIDE_RIGHT 2
+#define SIDE_BOTH (SIDE_LEFT | SIDE_RIGHT)
+
+struct NanoBoardProfile {
+  byte address;                 // I2C address
+  byte stripCount;              // RGB light bars on this board, all the same length
+  byte ledsPerStrip;            // LEDs in each strip, the main light indicator included
+  byte stripPins[MAX_STRIPS];   // Data pin of each strip
+  byte stripSides[MAX_STRIPS];  // SIDE_ of each strip
+  byte brightness;              // Initial strip brightness
+  byte rgbRelayPin;             // Relay powering the RGB LEDs
+  byte leftFloodRelayPin;       // Side flood lights, NO_PIN if the board has none
+  byte rightFloodRelayPin;
+  byte leftChaseRelayPin;       // Chase lights, NO_PIN if the board has none
+  byte rightChaseRelayPin;
+  uint64_t commands;            // COMMAND_BIT() of every command the board carries out
+};
+
+// Commands every board carries out
+#define NANO_COMMON_COMMANDS (COMMAND_BIT(CMD_RGB_POWER_OFF) | COMMAND_BIT(CMD_RGB_POWER_ON) | \
+                              COMMAND_BIT(CMD_ALL_OFF) | COMMAND_BIT(CMD_MAIN_OFF) | COMMAND_BIT(CMD_MAIN_ON) | \
+                              COMMAND_BIT(CMD_RGB_OFF) | COMMAND_BIT(CMD_CAUTION_CYCLE) | \
+                              COMMAND_BIT(CMD_RGB_SOLID) | COMMAND_BIT(CMD_RGB_RAINBOW) | COMMAND_BIT(CMD_RGB_BRIGHTNESS))
+
+// Nano 1 - Main Light Bar
+constexpr NanoBoardProfile NANO_MAIN_BAR_BOARD = {
+  I2C_MAIN_BAR_ADDRESS,
+  1, MAIN_BAR_NUM_LEDS,
+  {12}, {SIDE_BOTH},
+  255,
+  11,               // Relay #8
+  NO_PIN, NO_PIN,
+  NO_PIN, NO_PIN,
+  NANO_COMMON_COMMANDS | COMMAND_BIT(CMD_RGB_RED)
+};
+
+// Nano 2 - Rear Light Bar
+constexpr NanoBoardProfile NANO_REAR_BAR_BOARD = {
+  I2C_REAR_BAR_ADDRESS,
+  1, MAIN_BAR_NUM_LEDS,
+  {12}, {SIDE_BOTH},
+  255,
+  11,               // Relay #8
+  NO_PIN, NO_PIN,
+  NO_PIN, NO_PIN,
+  NANO_COMMON_COMMANDS | COMMAND_BIT(CMD_RGB_RED) |
+  COMMAND_BIT(CMD_HAZARD_LEFT) | COMMAND_BIT(CMD_HAZARD_RIGHT) | COMMAND_BIT(CMD_HAZARD_CENTER)
+};
+
+// Nano 3 - Side RGB Light Bars, Side Flood Lights and Chase Lights.  Strips
+// are front left, rear left, front right, rear right.
+constexpr NanoBoardProfile NANO_SIDE_BARS_BOARD = {
+  I2C_SIDE_BARS_ADDRESS,
+  4, SIDE_BAR_NUM_LEDS,
+  {12, 11, 10, 8}, {SIDE_LEFT, SIDE_LEFT, SIDE_RIGHT, SIDE_RIGHT},
+  255,
+  7,
+  6, 5,
+  4, 3,
+  NANO_COMMON_COMMANDS |
+  COMMAND_BIT(CMD_LEFT_MAIN_OFF) | COMMAND_BIT(CMD_LEFT_MAIN_ON) |
+  COMMAND_BIT(CMD_RIGHT_MAIN_OFF) | COMMAND_BIT(CMD_RIGHT_MAIN_ON) |
+  COMMAND_BIT(CMD_CHASE_OFF) | COMMAND_BIT(CMD_CHASE_ON)
+};
+
+#endif
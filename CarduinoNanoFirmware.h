@@ -0,0 +1,527 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano 1, 2 and 3          *
+*    Description: Light bar firmware       *
+*                 shared by every Nano     *
+*                                          *
+********************************************
+*/
+
+// The whole Nano firmware.  A Nano sketch defines NANO_BOARD as one of the
+// profiles in CarduinoNanoBoards.h and includes this file; the profile sets
+// the I2C address, the strips and relays the board drives and the commands
+// it answers.  A fix to a pattern or to the I2C handling lands on every board.
+
+#ifndef CARDUINO_NANO_FIRMWARE_H
+#define CARDUINO_NANO_FIRMWARE_H
+
+// Include libraries
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include "CarduinoCommandQueue.h"
+#include "CarduinoCommands.h"
+#include "CarduinoFrameScheduler.h"
+#include "CarduinoLightBar.h"
+#include "CarduinoNanoBoards.h"
+#include "CarduinoProtocol.h"
+#include "CarduinoSync.h"
+#include "CarduinoTimerWheel.h"
+
+#ifndef NANO_BOARD
+#error "Define NANO_BOARD as one of the profiles in CarduinoNanoBoards.h before including CarduinoNanoFirmware.h"
+#endif
+
+constexpr const NanoBoardProfile &nanoBoard = NANO_BOARD;
+
+// Check if this board carries out a command.  Known at compile time, so code
+// behind a false check is left out of the build.
+constexpr boolean boardHandles(byte opcode){
+  return (nanoBoard.commands & COMMAND_BIT(opcode)) != 0;
+}
+
+// Function prototypes
+void dataRcv(int numBytes);
+void updateOutputs();
+
+// Definitions
+#define I2C_MESSAGE_RECEIVED_LED_FLASH_LENGTH 250 // The milliseconds time that the light will flash for
+
+// I2C Variables
+CommandQueue i2cCommandQueue;  // Commands received from the I2C bus, waiting for updateOutputs()
+byte i2c_pattern;           // command being processed, taken from i2cCommandQueue
+byte i2c_option;            // option of the command being processed
+volatile unsigned int i2c_rejected_frames = 0; // frames thrown away for a bad length or CRC
+SharedClock sharedClock;    // network time and random seed from the Mega's sync frames
+PatternTimers patternTimers; // pattern step timers of the light bars, on sharedClock
+unsigned long i2c_message_LED_flash_start_timer;  // start time in milliseconds for flash
+int i2c_message_LED_status;               // status of LED: 1 = ON, 0 = OFF
+
+// Debug Variables
+boolean debugFrames = false; // Change to true will print frame overruns to the serial monitor
+
+// Currenly running pattern variables
+int currentPattern;
+int currentOption;
+
+// Build Classes
+template<byte PIN>
+class RelayDevice {
+  public:
+
+    // Methods
+    void begin(){
+      if(PIN != NO_PIN){
+        pinMode(PIN, OUTPUT);
+      }
+    }
+
+    void on(){
+      if(PIN != NO_PIN){
+        digitalWrite(PIN, HIGH);
+      }
+    }
+
+    void off(){
+      if(PIN != NO_PIN){
+        digitalWrite(PIN, LOW);
+      }
+    }
+};
+
+
+// Build Objects
+static_assert(nanoBoard.stripCount <= PATTERN_TIMER_COUNT, "Every light bar needs a pattern timer");
+RGBLightBar<nanoBoard.ledsPerStrip> lightBars[nanoBoard.stripCount];
+
+FrameScheduler frameScheduler(TARGET_FRAME_RATE);
+
+RelayDevice<nanoBoard.rgbRelayPin> RGBLightsRelay;
+RelayDevice<nanoBoard.leftFloodRelayPin> leftFloodLightsRelay;
+RelayDevice<nanoBoard.rightFloodRelayPin> rightFloodLightsRelay;
+RelayDevice<nanoBoard.leftChaseRelayPin> leftChaseLightRelay;
+RelayDevice<nanoBoard.rightChaseRelayPin> rightChaseLightRelay;
+
+
+void setup() {
+  // put your setup code here, to run once:
+
+  // ---I2C Setup---
+  Wire.begin(nanoBoard.address);  // join I2C bus as Slave with the board's address
+  TWAR |= _BV(TWGCE); // Also answer general call broadcasts from the Mega
+
+  // event handler initializations
+  Wire.onReceive(dataRcv);    // register an event handler for received data
+
+  // initialize global variables
+  i2c_pattern = 255;
+  i2c_option = 255;
+  currentPattern = 255;
+  currentOption = 255;
+  i2c_message_LED_flash_start_timer = millis();
+  i2c_message_LED_status = 0;
+
+  // Initialize Strips
+  patternTimers.begin(sharedClock.now());
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    lightBars[i].begin(nanoBoard.stripPins[i], nanoBoard.brightness);
+    lightBars[i].mainLightOff(); // Shut off main light after setup
+    lightBars[i].solidColor(off); // Shut off RGB ring after setup
+  }
+
+  // Initialize other outputs
+  RGBLightsRelay.begin();
+  leftFloodLightsRelay.begin();
+  rightFloodLightsRelay.begin();
+  leftChaseLightRelay.begin();
+  rightChaseLightRelay.begin();
+
+  // Frame timing
+  if(debugFrames){
+    Serial.begin(115200);
+    frameScheduler.reportOverruns(Serial);
+  }
+  frameScheduler.begin();
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+  patternTimers.tick(sharedClock.now()); // Expire the pattern steps that are due
+
+  updateOutputs();
+
+  // Turn off message LED
+  if((millis() - i2c_message_LED_flash_start_timer) > I2C_MESSAGE_RECEIVED_LED_FLASH_LENGTH){
+    i2c_message_LED_status = 0; // Turn off Light
+  }
+
+  digitalWrite(13, i2c_message_LED_status); // Update LED State
+
+  // Run the LED updates if any are pending
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    lightBars[i].runUpdates();
+    lightBars[i].scheduleNextUpdate(frameScheduler);
+  }
+
+  frameScheduler.waitForNextFrame(); // Sleep until the next pattern step, I2C message or frame
+}
+
+
+// --Functions--
+
+// received data handler function
+void dataRcv(int numBytes){
+  byte frame[I2C_FRAME_MAX_LENGTH];
+  byte length = 0;
+
+  while(Wire.available()) { // read all bytes received
+    byte data = Wire.read();
+    if(length < I2C_FRAME_MAX_LENGTH){
+      frame[length] = data;
+    }
+    length ++;
+  }
+
+  // Throw away anything that is not a whole frame with a good CRC
+  if(!i2cFrameValid(frame, length)){
+    i2c_rejected_frames ++;
+    return;
+  }
+
+  // Queue the commands for this board so any that arrive before updateOutputs() runs are not lost
+  boolean selected = true;
+  byte queued = 0;
+  for(byte i = 0; i < frame[0]; i++){
+    byte pattern = frame[2 * i + 1];
+    byte option = frame[2 * i + 2];
+
+    if(pattern == I2C_SELECT_TARGETS){ // Broadcast frame saying which boards the next commands are for
+      selected = option & I2C_TARGET_MASK(nanoBoard.address);
+    } else if(pattern == I2C_SYNC){ // Time sync, the time is in the next pairs
+      if(i + I2C_SYNC_DATA_PAIRS < frame[0]){
+        byte *time = &frame[2 * i + 3];
+        sharedClock.sync(((unsigned long)time[0] << 24) | ((unsigned long)time[1] << 16) | ((unsigned long)time[2] << 8) | time[3], option);
+      }
+      i += I2C_SYNC_DATA_PAIRS;
+    } else if(selected){
+      i2cCommandQueue.push(pattern, option);
+      queued ++;
+    }
+  }
+
+  if(queued == 0){ // Broadcast with nothing for this board
+    return;
+  }
+
+  i2c_message_LED_status = 1; // Turn on the LED
+  i2c_message_LED_flash_start_timer = millis();
+  frameScheduler.notifyEvent(); // Wake loop() to handle the message
+}
+
+// Main lights of the strips on one side ON
+void mainLightsOn(byte side){
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    if(nanoBoard.stripSides[i] & side){
+      lightBars[i].mainLightOn();
+    }
+  }
+}
+
+// Main lights of the strips on one side OFF
+void mainLightsOff(byte side){
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    if(nanoBoard.stripSides[i] & side){
+      lightBars[i].mainLightOff();
+    }
+  }
+}
+
+// Every RGB ring one color
+void allSolidColor(uint32_t color){
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    lightBars[i].solidColor(color);
+  }
+}
+
+// RGB Light Bar(s) Power OFF
+void handleRGBPowerOff(byte option){
+  RGBLightsRelay.off(); // Kill relay to RGB LEDs
+}
+
+// RGB Light Bar(s) Power On - the Mega holds the next commands for RGB_POWER_SETTLE_TIME while the LEDs power up
+void handleRGBPowerOn(byte option){
+  RGBLightsRelay.on(); // Power relay to RGB LEDs
+}
+
+// All lights OFF
+void handleAllOff(byte option){
+  // Reset the current Pattern/Option to the default of 255
+  currentPattern = 255;
+  currentOption = 255;
+
+  mainLightsOff(SIDE_BOTH);
+  allSolidColor(off);
+  leftFloodLightsRelay.off();
+  rightFloodLightsRelay.off();
+  leftChaseLightRelay.off();
+  rightChaseLightRelay.off();
+}
+
+// All main lights OFF
+void handleMainOff(byte option){
+  mainLightsOff(SIDE_BOTH);
+  leftFloodLightsRelay.off();
+  rightFloodLightsRelay.off();
+}
+
+// All main lights ON
+void handleMainOn(byte option){
+  mainLightsOn(SIDE_BOTH);
+  leftFloodLightsRelay.on();
+  rightFloodLightsRelay.on();
+}
+
+// Left main lights OFF
+void handleLeftMainOff(byte option){
+  mainLightsOff(SIDE_LEFT);
+  leftFloodLightsRelay.off();
+}
+
+// Left (only) main lights ON
+void handleLeftMainOn(byte option){
+  mainLightsOn(SIDE_LEFT);
+  mainLightsOff(SIDE_RIGHT);
+  leftFloodLightsRelay.on();
+  rightFloodLightsRelay.off();
+}
+
+// Right main lights OFF
+void handleRightMainOff(byte option){
+  mainLightsOff(SIDE_RIGHT);
+  rightFloodLightsRelay.off();
+}
+
+// Right (only) main lights ON
+void handleRightMainOn(byte option){
+  mainLightsOn(SIDE_RIGHT);
+  mainLightsOff(SIDE_LEFT);
+  rightFloodLightsRelay.on();
+  leftFloodLightsRelay.off();
+}
+
+// Chase lights OFF
+void handleChaseOff(byte option){
+  leftChaseLightRelay.off();
+  rightChaseLightRelay.off();
+}
+
+// Chase lights ON
+void handleChaseOn(byte option){
+  leftChaseLightRelay.on();
+  rightChaseLightRelay.on();
+}
+
+// RGB (All) OFF
+void handleRGBOff(byte option){
+  // Reset the Current Patern and Option to the default of 255
+  currentPattern = 255;
+  currentOption = 255;
+
+  allSolidColor(off);
+}
+
+// RGB (All) Red
+void handleRGBRed(byte option){
+  allSolidColor(red);
+}
+
+// RGB caution pattern cycle
+void handleCautionCycle(byte option){
+  currentPattern = CMD_CAUTION_CYCLE;
+
+  // Same sequence as the other bars
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    lightBars[i].startCautionPatternCycle(sharedClock.checkSeed());
+  }
+}
+
+// RGB hazard left
+void handleHazardLeft(byte option){
+  currentPattern = CMD_HAZARD_LEFT;
+}
+
+// RGB hazard right
+void handleHazardRight(byte option){
+  currentPattern = CMD_HAZARD_RIGHT;
+}
+
+// RGB hazard center
+void handleHazardCenter(byte option){
+  currentPattern = CMD_HAZARD_CENTER;
+}
+
+// RGB (all) Solid - option is the color
+void handleRGBSolid(byte option){
+  uint32_t color;
+
+  switch(option){
+    case RGB_COLOR_OFF:
+      color = off;
+      break;
+    case RGB_COLOR_WHITE:
+      color = white;
+      break;
+    case RGB_COLOR_RED:
+      color = red;
+      break;
+    case RGB_COLOR_GREEN:
+      color = green;
+      break;
+    case RGB_COLOR_BLUE:
+      color = blue;
+      break;
+    case RGB_COLOR_ORANGE:
+      color = orange;
+      break;
+    case RGB_COLOR_YELLOW:
+      color = yellow;
+      break;
+    case RGB_COLOR_PURPLE:
+      color = purple;
+      break;
+    default: // Unknown color, leave the lights as they are
+      return;
+  }
+
+  // Stop the running pattern so it does not paint over the color
+  currentPattern = 255;
+  currentOption = 255;
+
+  allSolidColor(color);
+}
+
+// RGB (all) Rainbow Road - option is the speed
+void handleRainbow(byte option){
+  currentPattern = CMD_RGB_RAINBOW;
+  currentOption = option;
+}
+
+// RGB (all) Brightness - option is the brightness, 0 - 255
+void handleRGBBrightness(byte option){
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    lightBars[i].setBrightness(option);
+  }
+}
+
+// Only the handlers for commands in the board's profile go in the table, the rest are left out of the build
+#define BOARD_HANDLER(opcode, handler) (boardHandles(opcode) ? handler : NULL)
+
+// Handlers in commandIndex() order, NULL where this board has nothing to do
+const CommandHandler commandHandlers[COMMAND_COUNT] PROGMEM = {
+  BOARD_HANDLER(CMD_RGB_POWER_OFF, handleRGBPowerOff),
+  BOARD_HANDLER(CMD_RGB_POWER_ON, handleRGBPowerOn),
+  BOARD_HANDLER(CMD_ALL_OFF, handleAllOff),
+  BOARD_HANDLER(CMD_MAIN_OFF, handleMainOff),
+  BOARD_HANDLER(CMD_MAIN_ON, handleMainOn),
+  BOARD_HANDLER(CMD_LEFT_MAIN_OFF, handleLeftMainOff),
+  BOARD_HANDLER(CMD_LEFT_MAIN_ON, handleLeftMainOn),
+  BOARD_HANDLER(CMD_RIGHT_MAIN_OFF, handleRightMainOff),
+  BOARD_HANDLER(CMD_RIGHT_MAIN_ON, handleRightMainOn),
+  BOARD_HANDLER(CMD_CHASE_OFF, handleChaseOff),
+  BOARD_HANDLER(CMD_CHASE_ON, handleChaseOn),
+  BOARD_HANDLER(CMD_RGB_OFF, handleRGBOff),
+  BOARD_HANDLER(CMD_RGB_RED, handleRGBRed),
+  NULL,             // CMD_RGB_LEFT_RED - add this functionality later
+  NULL,             // CMD_RGB_RIGHT_RED - add this functionality later
+  NULL,             // CMD_TURN_LEFT_OFF - program this later
+  NULL,             // CMD_TURN_LEFT_ON - program this later
+  NULL,             // CMD_TURN_RIGHT_OFF - program this later
+  NULL,             // CMD_TURN_RIGHT_ON - program this later
+  NULL,             // CMD_BRAKE_OFF - program this later
+  NULL,             // CMD_BRAKE_ON - program this later
+  BOARD_HANDLER(CMD_CAUTION_CYCLE, handleCautionCycle),
+  BOARD_HANDLER(CMD_HAZARD_LEFT, handleHazardLeft),
+  BOARD_HANDLER(CMD_HAZARD_RIGHT, handleHazardRight),
+  BOARD_HANDLER(CMD_HAZARD_CENTER, handleHazardCenter),
+  BOARD_HANDLER(CMD_RGB_SOLID, handleRGBSolid),
+  NULL,             // CMD_RGB_JUMP - program this later
+  NULL,             // CMD_RGB_FADE - program this later
+  NULL,             // CMD_RGB_FADE_OUT - program this later
+  NULL,             // CMD_RGB_CHASE_FADE - program this later
+  NULL,             // CMD_RGB_CHASE_FADE_OUT - program this later
+  BOARD_HANDLER(CMD_RGB_RAINBOW, handleRainbow),
+  BOARD_HANDLER(CMD_RGB_BRIGHTNESS, handleRGBBrightness)
+};
+
+// Make decisions based on the newly received I2C messages
+void updateOutputs(){
+
+  // Process incoming I2C Messages and Instantanios decisions, oldest first
+  while(i2cCommandQueue.pop(i2c_pattern, i2c_option)){
+    dispatchCommand(commandHandlers, i2c_pattern, i2c_option);
+
+    // Reset i2c variables back to 255
+    i2c_pattern = 255;
+    i2c_option = 255;
+  }
+
+  // Process continuous patterns
+  for(byte i = 0; i < nanoBoard.stripCount; i++){
+    switch(currentPattern){
+
+      case CMD_CAUTION_CYCLE: // Caution Pattern Cycle - 255 No 2nd perameter
+
+        lightBars[i].cautionPatternCycle();
+
+        break;
+
+      case CMD_HAZARD_LEFT: // RBG hazard left
+
+        if(boardHandles(CMD_HAZARD_LEFT)){
+          lightBars[i].hazardPatternRearBar(1);
+        }
+
+        break;
+
+      case CMD_HAZARD_RIGHT: // RBG hazard Right
+
+        if(boardHandles(CMD_HAZARD_RIGHT)){
+          lightBars[i].hazardPatternRearBar(2);
+        }
+
+        break;
+
+      case CMD_HAZARD_CENTER: // RBG hazard Center
+
+        if(boardHandles(CMD_HAZARD_CENTER)){
+          lightBars[i].hazardPatternRearBar(0);
+        }
+
+        break;
+
+      case CMD_RGB_RAINBOW: // Rainbow - 80 Full Speed | 81 Fast | 82 Moderate | 83 Slow
+
+        switch(currentOption){
+          case RAINBOW_FULL_SPEED: // Full Speed
+            lightBars[i].rainbow(0);
+            break;
+          case RAINBOW_FAST: // Fast
+            lightBars[i].rainbow(1);
+            break;
+          case RAINBOW_MODERATE: // Moderate
+            lightBars[i].rainbow(2);
+            break;
+          case RAINBOW_SLOW: // Slow
+            lightBars[i].rainbow(3);
+            break;
+        }
+
+        break;
+    }
+  }
+}
+
+#endif
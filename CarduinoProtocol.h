@@ -0,0 +1,95 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega and Nanos      *
+*    Description: I2C frame format shared  *
+*                 by the Mega and the      *
+*                 Nanos                    *
+*                                          *
+********************************************
+*/
+
+// Every I2C transaction from the Mega carries one frame:
+//
+//   [count] [pattern, option] x count [CRC-8]
+//
+// Commands without an option send I2C_NO_OPTION in its place.  The CRC covers
+// every byte before it (CRC-8, polynomial 0x07, initial value 0).  A frame has
+// to fit in the 32 byte Wire buffer, which allows up to 15 commands.
+//
+// Frames that concern more than one bar go out once as an I2C general call
+// (address 0), which every Nano answers.  Inside such a frame an
+// I2C_SELECT_TARGETS command, with a mask of target bits as its option, says
+// which boards the commands after it are for.  A frame sent to one address
+// starts out selecting that board.
+//
+// I2C_SYNC is followed by two pairs that carry data instead of commands: the
+// Mega's millis() at the time of sending, most significant byte first.  The
+// option of the sync itself is the shared random seed (see CarduinoSync.h).
+//
+//   [I2C_SYNC, seed] [time >> 24, time >> 16] [time >> 8, time]
+
+#ifndef CARDUINO_PROTOCOL_H
+#define CARDUINO_PROTOCOL_H
+
+#include <Arduino.h>
+
+// Addresses
+#define I2C_GENERAL_CALL_ADDRESS 0
+#define I2C_MAIN_BAR_ADDRESS 8
+#define I2C_REAR_BAR_ADDRESS 9
+#define I2C_SIDE_BARS_ADDRESS 10
+#define I2C_TARGET_MASK(address) (1 << ((address) - I2C_MAIN_BAR_ADDRESS)) // Bit for a Nano in an I2C_SELECT_TARGETS mask
+
+// Opcodes the Nanos handle in dataRcv() rather than queueing
+#define I2C_SELECT_TARGETS 250 // Option is the target mask for the commands that follow
+#define I2C_SYNC 251           // Option is the random seed, the next two pairs hold the time
+#define I2C_SYNC_DATA_PAIRS 2
+
+#define I2C_NO_OPTION 255
+#define I2C_FRAME_MAX_COMMANDS 15
+#define I2C_FRAME_LENGTH(count) (2 * (count) + 2) // Count byte, command pairs, CRC byte
+#define I2C_FRAME_MAX_LENGTH I2C_FRAME_LENGTH(I2C_FRAME_MAX_COMMANDS)
+
+inline byte i2cCrc8(const byte *data, byte length){
+  byte crc = 0;
+
+  for(byte i = 0; i < length; i++){
+    crc ^= data[i];
+    for(byte b = 0; b < 8; b++){
+      if(crc & 0x80){
+        crc = (crc << 1) ^ 0x07;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+
+  return crc;
+}
+
+// Fill in the count and CRC of a frame whose commands are already in place.  Returns the frame length.
+inline byte i2cFrameFinish(byte *frame, byte count){
+  byte length = I2C_FRAME_LENGTH(count);
+
+  frame[0] = count;
+  frame[length - 1] = i2cCrc8(frame, length - 1);
+
+  return length;
+}
+
+// Check a received frame's length against its count and its CRC
+inline boolean i2cFrameValid(const byte *frame, byte length){
+  if(length < I2C_FRAME_LENGTH(1) || length > I2C_FRAME_MAX_LENGTH){
+    return false;
+  }
+
+  if(frame[0] == 0 || length != I2C_FRAME_LENGTH(frame[0])){
+    return false;
+  }
+
+  return i2cCrc8(frame, length - 1) == frame[length - 1];
+}
+
+#endif
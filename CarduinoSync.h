@@ -0,0 +1,146 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega and Nanos      *
+*    Description: Network time base and    *
+*                 shared random numbers    *
+*                                          *
+********************************************
+*/
+
+// The Mega broadcasts its millis() and a random seed every I2C_SYNC_INTERVAL
+// (see CarduinoProtocol.h for the frame).  Each Nano keeps a SharedClock that
+// follows the Mega's time, corrected for how fast its own resonator runs, so
+// the same pattern step lands at the same moment on every bar.  Patterns that
+// pick sub-patterns at random draw from a SharedRandom started from the shared
+// seed, so every bar makes the same picks.
+
+#ifndef CARDUINO_SYNC_H
+#define CARDUINO_SYNC_H
+
+#include <Arduino.h>
+
+#define I2C_SYNC_INTERVAL 1000     // Milliseconds between time syncs from the Mega
+#define SYNC_MAX_GAP 10000         // Syncs further apart than this are not used to measure drift
+#define SYNC_RATE_SCALE 65536L     // Clock rate correction is in 1/65536ths
+#define SYNC_RATE_LIMIT 1311       // About 2%, well past any resonator
+#define SYNC_JUMP_LIMIT 500        // Milliseconds the clocks can part between syncs before it is a jump, not drift
+
+class SharedClock {
+  private:
+    volatile unsigned long localAtSync = 0;    // Our millis() when the last sync arrived
+    volatile unsigned long networkAtSync = 0;  // The Mega's millis() in that sync
+    volatile long rate = 0;                    // How much faster the Mega's clock runs than ours, in 1/65536ths
+    volatile byte seed = 0;
+    volatile boolean synced = false;
+
+    // Drift over an elapsed time.  Stops growing if syncs stop coming, which
+    // also keeps the multiply inside a long.
+    long correction(long elapsed, long currentRate){
+      elapsed = constrain(elapsed, -SYNC_MAX_GAP, SYNC_MAX_GAP);
+      return (elapsed * currentRate) / SYNC_RATE_SCALE;
+    }
+
+  public:
+
+    // Methods
+
+    // Called from the I2C receive handler with the time in a sync frame
+    void sync(unsigned long networkTime, byte newSeed){
+      unsigned long localTime = millis();
+
+      if(synced){
+        long localElapsed = localTime - localAtSync;
+        long drift = (networkTime - networkAtSync) - (localTime - localAtSync); // Unsigned, so a Mega reset cannot overflow it
+
+        if(drift > SYNC_JUMP_LIMIT || drift < -SYNC_JUMP_LIMIT){ // The Mega reset or syncs were lost, start measuring again
+          rate = 0;
+        } else if(localElapsed > 0 && localElapsed < SYNC_MAX_GAP){
+          long measuredRate = (drift * SYNC_RATE_SCALE) / localElapsed;
+          measuredRate = constrain(measuredRate, -SYNC_RATE_LIMIT, SYNC_RATE_LIMIT);
+          rate += (measuredRate - rate) / 4; // Average out the 1 ms steps in millis()
+        }
+      }
+
+      localAtSync = localTime;
+      networkAtSync = networkTime;
+      seed = newSeed;
+      synced = true;
+    }
+
+    // Network time in milliseconds, or our own millis() until the first sync
+    unsigned long now(){
+      noInterrupts();
+      unsigned long localAt = localAtSync;
+      unsigned long networkAt = networkAtSync;
+      long currentRate = rate;
+      boolean haveSync = synced;
+      interrupts();
+
+      unsigned long localTime = millis();
+      if(!haveSync){
+        return localTime;
+      }
+
+      long elapsed = localTime - localAt;
+      return networkAt + elapsed + correction(elapsed, currentRate);
+    }
+
+    // Our millis() at a given network time, for the frame scheduler
+    unsigned long localTime(unsigned long networkTime){
+      noInterrupts();
+      unsigned long localAt = localAtSync;
+      unsigned long networkAt = networkAtSync;
+      long currentRate = rate;
+      boolean haveSync = synced;
+      interrupts();
+
+      if(!haveSync){
+        return networkTime;
+      }
+
+      long elapsed = networkTime - networkAt;
+      return localAt + elapsed - correction(elapsed, currentRate);
+    }
+
+    byte checkSeed(){
+      return seed;
+    }
+
+    long checkRate(){
+      return rate;
+    }
+
+    boolean checkSynced(){
+      return synced;
+    }
+};
+
+// Small pseudo random number generator (xorshift) so each light bar can have
+// its own sequence, separate from random()
+class SharedRandom {
+  private:
+    unsigned long state = 1;
+
+  public:
+
+    // Methods
+    void seed(byte newSeed){
+      state = 0x9E3779B9UL ^ ((unsigned long)newSeed * 0x01010101UL); // Spread the byte so every seed starts well mixed
+      if(state == 0){
+        state = 1;
+      }
+    }
+
+    // Same range as random(howSmall, howBig): howSmall up to but not including howBig
+    long next(long howSmall, long howBig){
+      state ^= (state << 13) & 0xFFFFFFFFUL; // Masked because unsigned long is wider than 32 bits on the host
+      state ^= state >> 17;
+      state ^= (state << 5) & 0xFFFFFFFFUL;
+
+      return howSmall + (long)(state % (unsigned long)(howBig - howSmall));
+    }
+};
+
+#endif
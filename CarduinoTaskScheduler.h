@@ -0,0 +1,176 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega                *
+*    Description: Cooperative task         *
+*                 scheduler for loop()     *
+*                                          *
+********************************************
+*/
+
+// Splits the Mega loop() into tasks that each run at their own rate.  A task
+// is a function that does one pass of its work and returns.  run() starts
+// every task that is due, in the order they were added, then idles until the
+// next interrupt if none was.  Times are millis() ticks and every comparison
+// is a difference, so they carry on through the rollover.
+//
+// A task that starts more than its deadline after it was due counts a
+// deadline miss, and one that has fallen a whole period behind skips the runs
+// it missed instead of running back to back.  Each task also keeps the
+// shortest, longest and average time its runs took, in microseconds, so
+// report() shows what is eating the loop.
+
+#ifndef CARDUINO_TASK_SCHEDULER_H
+#define CARDUINO_TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+
+typedef void (*TaskFunction)();
+
+template<byte TASKS>
+class TaskScheduler {
+  private:
+
+    struct Task {
+      const char *name;
+      TaskFunction function;
+      unsigned int period;   // Milliseconds between runs
+      unsigned int deadline; // Milliseconds a run can start after it was due
+      unsigned long dueTime;
+
+      // Statistics
+      unsigned long runs;
+      unsigned long deadlineMisses;
+      unsigned long shortestRun;
+      unsigned long longestRun;
+      unsigned long totalRunTime; // Wraps after about 71 minutes of the task running, see resetStats()
+    };
+
+    Task tasks[TASKS];
+    byte taskCount = 0;
+
+  public:
+
+    // Methods
+
+    // Add a task, returns its number.  Tasks run in the order they are added.
+    byte addTask(const char *name, TaskFunction function, unsigned int period, unsigned int deadline){
+      Task &task = tasks[taskCount];
+
+      task.name = name;
+      task.function = function;
+      task.period = period;
+      task.deadline = deadline;
+      task.dueTime = millis();
+
+      return taskCount ++;
+    }
+
+    void begin(){
+      unsigned long now = millis();
+
+      for(byte t = 0; t < taskCount; t++){
+        tasks[t].dueTime = now;
+      }
+      resetStats();
+    }
+
+    void resetStats(){
+      for(byte t = 0; t < taskCount; t++){
+        tasks[t].runs = 0;
+        tasks[t].deadlineMisses = 0;
+        tasks[t].shortestRun = 0xFFFFFFFF;
+        tasks[t].longestRun = 0;
+        tasks[t].totalRunTime = 0;
+      }
+    }
+
+    // One pass of loop()
+    void run(){
+      boolean ranTask = false;
+
+      for(byte t = 0; t < taskCount; t++){
+        Task &task = tasks[t];
+        unsigned long now = millis();
+        unsigned long lateness = now - task.dueTime;
+
+        if((long)lateness < 0){ // Not due yet
+          continue;
+        }
+
+        if(lateness > task.deadline){
+          task.deadlineMisses ++;
+        }
+
+        // Next run one period on, or one period from now if a whole period has been missed
+        task.dueTime += task.period;
+        if((long)(now - task.dueTime) >= 0){
+          task.dueTime = now + task.period;
+        }
+
+        unsigned long start = micros();
+        task.function();
+        unsigned long runTime = micros() - start;
+
+        task.runs ++;
+        task.totalRunTime += runTime;
+        if(runTime < task.shortestRun){
+          task.shortestRun = runTime;
+        }
+        if(runTime > task.longestRun){
+          task.longestRun = runTime;
+        }
+
+        ranTask = true;
+      }
+
+      // Nothing was due - idle until an interrupt, at the latest the next millis() tick
+      if(!ranTask){
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_mode();
+      }
+    }
+
+    // Print every task's statistics
+    void report(HardwareSerial &serial){
+      serial.println(F("Task runs deadline-misses min/avg/max us"));
+      for(byte t = 0; t < taskCount; t++){
+        serial.print(tasks[t].name);
+        serial.print(F(" "));
+        serial.print(tasks[t].runs);
+        serial.print(F(" "));
+        serial.print(tasks[t].deadlineMisses);
+        serial.print(F(" "));
+        serial.print(checkShortestRun(t));
+        serial.print(F("/"));
+        serial.print(checkAverageRun(t));
+        serial.print(F("/"));
+        serial.println(tasks[t].longestRun);
+      }
+    }
+
+    unsigned long checkRuns(byte task){
+      return tasks[task].runs;
+    }
+
+    unsigned long checkDeadlineMisses(byte task){
+      return tasks[task].deadlineMisses;
+    }
+
+    unsigned long checkShortestRun(byte task){
+      return tasks[task].runs ? tasks[task].shortestRun : 0;
+    }
+
+    unsigned long checkAverageRun(byte task){
+      return tasks[task].runs ? tasks[task].totalRunTime / tasks[task].runs : 0;
+    }
+
+    unsigned long checkLongestRun(byte task){
+      return tasks[task].longestRun;
+    }
+
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Main Mega and Nanos      *
+*    Description: Timer wheel for pattern  *
+*                 steps and sleep timers   *
+*                                          *
+********************************************
+*/
+
+// A small hashed timer wheel.  The wheel keeps its own 16 bit tick count,
+// which tick() moves on by however far the clock has gone since the last
+// call, so the clock is read once per pass by the caller and handed in.
+// A tick is 2^TICK_SHIFT milliseconds of that clock.
+//
+// Every deadline is a 16 bit tick and is compared as a signed difference to
+// the current tick, so nothing goes wrong when millis() or the tick count
+// rolls over.  A deadline can be at most TIMER_WHEEL_MAX_TICKS ahead.  A
+// running timer sits in the slot of its deadline, and tick() only looks at
+// the slots the wheel has turned past, so checkExpired() is a bit test.
+//
+// The wheel never turns backwards.  If the clock is stepped back, such as
+// the shared clock taking its first sync from the Mega, the wheel carries
+// on from the new time and no timer fires early or late because of it.
+// tick() and the timer calls are for loop() only, not interrupts.
+
+#ifndef CARDUINO_TIMER_WHEEL_H
+#define CARDUINO_TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+#define TIMER_WHEEL_SLOTS 8          // Slots round the wheel, a power of two
+#define TIMER_WHEEL_MAX_TIMERS 8     // One bit each in a slot
+#define TIMER_WHEEL_MAX_TICKS 32767  // Furthest ahead a deadline can be
+
+// Ticks of 2^shift milliseconds in a time, rounded up so a timer never runs short
+#define TIMER_WHEEL_TICKS(milliseconds, shift) ((uint16_t)(((milliseconds) + (1UL << (shift)) - 1) >> (shift)))
+
+template<byte TIMERS, byte TICK_SHIFT = 0>
+class TimerWheel {
+  static_assert(TIMERS <= TIMER_WHEEL_MAX_TIMERS, "A slot holds at most TIMER_WHEEL_MAX_TIMERS timers");
+
+  private:
+
+    uint16_t deadlines[TIMERS] = {};
+    byte slots[TIMER_WHEEL_SLOTS] = {}; // Running timers, by the slot of their deadline
+    byte running = 0;                   // Timers waiting for their deadline
+    byte expired = 0;                   // Timers whose deadline has been reached
+    byte timerCount = 0;
+    uint16_t currentTick = 0;
+    unsigned long lastTime = 0;         // Clock time of currentTick
+
+  public:
+
+    // Methods
+
+    // Add a timer, returns its number.  It starts out stopped.
+    byte addTimer(){
+      return timerCount ++;
+    }
+
+    void begin(unsigned long now){
+      lastTime = now;
+    }
+
+    // Move the wheel on to the clock time now and expire the timers it passes
+    void tick(unsigned long now){
+      unsigned long elapsed = now - lastTime;
+
+      if((long)elapsed < 0){ // Clock stepped back, carry on from here
+        lastTime = now;
+        return;
+      }
+
+      unsigned long ticks = elapsed >> TICK_SHIFT;
+      if(ticks == 0){
+        return;
+      }
+
+      if(ticks > TIMER_WHEEL_MAX_TICKS){ // Every deadline has passed
+        ticks = TIMER_WHEEL_MAX_TICKS;
+        lastTime = now;
+      } else {
+        lastTime += ticks << TICK_SHIFT; // Keep the part of a tick that has gone by
+      }
+
+      // Check the slots the wheel turns past, each one once if it goes all the way round
+      byte slot = currentTick;
+      byte turned = ticks < TIMER_WHEEL_SLOTS ? ticks : TIMER_WHEEL_SLOTS;
+      currentTick += ticks;
+
+      while(turned --){
+        slot = (slot + 1) & (TIMER_WHEEL_SLOTS - 1);
+
+        byte waiting = slots[slot];
+        for(byte timer = 0; waiting; timer++, waiting >>= 1){
+          if((waiting & 1) && (int16_t)(currentTick - deadlines[timer]) >= 0){
+            byte bit = 1 << timer;
+
+            slots[slot] &= ~bit;
+            running &= ~bit;
+            expired |= bit;
+          }
+        }
+      }
+    }
+
+    // Expire a timer at a tick.  Setting the deadline it already has changes
+    // nothing, so a pattern can ask for the same step on every pass.
+    void startAt(byte timer, uint16_t deadline){
+      byte bit = 1 << timer;
+
+      if(deadlines[timer] == deadline && ((running | expired) & bit)){
+        return;
+      }
+
+      stop(timer);
+      deadlines[timer] = deadline;
+
+      if((int16_t)(deadline - currentTick) <= 0){
+        expired |= bit;
+      } else {
+        running |= bit;
+        slots[deadline & (TIMER_WHEEL_SLOTS - 1)] |= bit;
+      }
+    }
+
+    // Expire a timer a number of ticks from now
+    void start(byte timer, uint16_t ticks){
+      startAt(timer, currentTick + ticks);
+    }
+
+    void stop(byte timer){
+      byte bit = 1 << timer;
+
+      slots[deadlines[timer] & (TIMER_WHEEL_SLOTS - 1)] &= ~bit;
+      running &= ~bit;
+      expired &= ~bit;
+    }
+
+    boolean checkExpired(byte timer){
+      return expired & (1 << timer);
+    }
+
+    boolean checkRunning(byte timer){
+      return running & (1 << timer);
+    }
+
+    uint16_t checkTick(){
+      return currentTick;
+    }
+
+    // Clock time of a tick near the current one, for sleeping until a deadline
+    unsigned long checkTime(uint16_t tick){
+      return lastTime + (long)(int16_t)(tick - currentTick) * (1L << TICK_SHIFT);
+    }
+
+};
+
+#endif
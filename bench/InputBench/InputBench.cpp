@@ -0,0 +1,159 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Mega (simavr)            *
+*    Description: 74HC165 input chain      *
+*                 read cycle count         *
+*                                          *
+********************************************
+*/
+
+// Reads the 74HC165 input chain over and over, first the way readInputs()
+// used to (digitalWrite() load pulse with 5 us delays and four shiftIn()
+// calls) and then with InputChain, and counts the CPU cycles of every read
+// using Timer1 as a cycle counter.  Meant to be run under simavr by
+// bench/avr_bench.sh on the Mega, which copies the shared Carduino headers
+// in next to this file.  Results are printed on Serial, one "BENCH_READ"
+// line per reader.
+
+// Include libraries
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "CarduinoInputChain.h"
+
+// Constants
+#define BENCH_READS 1000
+
+// Same pins as the Mega sketch
+#define LOAD_PIN      23 // PL pin 1
+#define CLK_ENAB_PIN  25 // CE pin 15
+#define DATA_IN_PIN   27 // Q7 pin 9
+#define CLK_IN_PIN    29 // CP pin 2
+
+InputChain<4> inputChain(LOAD_PIN, CLK_ENAB_PIN, DATA_IN_PIN, CLK_IN_PIN);
+
+// Cycle counter - Timer1 at the CPU clock, extended to 32 bits by its overflow interrupt
+volatile uint16_t timer1Overflows = 0;
+uint32_t cycleCountOverhead = 0;
+
+ISR(TIMER1_OVF_vect){
+  timer1Overflows ++;
+}
+
+uint32_t cycleCount(){
+  uint8_t oldSREG = SREG;
+  cli();
+
+  uint16_t low = TCNT1;
+  uint16_t high = timer1Overflows;
+
+  // Overflow happened but its interrupt has not run yet
+  if((TIFR1 & _BV(TOV1)) && low < 0x8000){
+    high ++;
+  }
+
+  SREG = oldSREG;
+
+  return ((uint32_t)high << 16) | low;
+}
+
+// readInputs() before InputChain
+uint32_t legacyRead(){
+  byte shift_0, shift_1, shift_2, shift_3;
+
+  digitalWrite(LOAD_PIN, LOW);
+  delayMicroseconds(5);
+  digitalWrite(LOAD_PIN, HIGH);
+  delayMicroseconds(5);
+
+  digitalWrite(CLK_IN_PIN, HIGH);
+  digitalWrite(CLK_ENAB_PIN, LOW);
+  shift_0 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
+  shift_1 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
+  shift_2 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
+  shift_3 = shiftIn(DATA_IN_PIN, CLK_IN_PIN, MSBFIRST);
+  digitalWrite(CLK_ENAB_PIN, HIGH);
+
+  return (uint32_t)shift_0 | ((uint32_t)shift_1 << 8) | ((uint32_t)shift_2 << 16) | ((uint32_t)shift_3 << 24);
+}
+
+uint32_t inputChainRead(){
+  uint32_t inputs[inputChain.words];
+
+  inputChain.read(inputs);
+
+  return inputs[0];
+}
+
+volatile uint32_t benchSink; // Keeps the reads from being optimised away
+
+void runReader(const char *name, uint32_t (*reader)()){
+  uint32_t totalCycles = 0;
+  uint32_t minCycles = 0xFFFFFFFF;
+  uint32_t maxCycles = 0;
+
+  for(int i = 0; i < BENCH_READS; i++){
+    uint32_t readStart = cycleCount();
+    benchSink = reader();
+    uint32_t readEnd = cycleCount();
+
+    uint32_t readCycles = readEnd - readStart - cycleCountOverhead;
+
+    totalCycles += readCycles;
+    if(readCycles < minCycles){
+      minCycles = readCycles;
+    }
+    if(readCycles > maxCycles){
+      maxCycles = readCycles;
+    }
+  }
+
+  // BENCH_READ <reader> <reads> <min> <avg> <max>
+  Serial.print(F("BENCH_READ "));
+  Serial.print(name);
+  Serial.print(' ');
+  Serial.print(BENCH_READS);
+  Serial.print(' ');
+  Serial.print(minCycles);
+  Serial.print(' ');
+  Serial.print(totalCycles / BENCH_READS);
+  Serial.print(' ');
+  Serial.println(maxCycles);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  inputChain.begin();
+
+  // Take Timer1 away from analogWrite() and run it at the CPU clock
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 = _BV(TOIE1);
+
+  // Cost of the two cycleCount() calls around an empty read
+  uint32_t calibrateStart = cycleCount();
+  uint32_t calibrateEnd = cycleCount();
+  cycleCountOverhead = calibrateEnd - calibrateStart;
+
+  Serial.print(F("BENCH_CPU "));
+  Serial.println(F_CPU);
+
+  runReader("shiftIn", legacyRead);
+  runReader("InputChain", inputChainRead);
+
+  Serial.println(F("BENCH_DONE"));
+  Serial.flush();
+
+  // simavr stops when the CPU sleeps with interrupts off
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+}
+
+void loop() {
+}
@@ -0,0 +1,2 @@
+// The benchmark lives in InputBench.cpp. This file only exists because the
+// Arduino tools need a .ino named after the sketch folder.
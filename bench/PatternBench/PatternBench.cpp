@@ -0,0 +1,192 @@
+/*
+********************************************
+*                                          *
+*        Project: Wrexus Carduino Controls *
+*          Board: Nano / Mega (simavr)     *
+*    Description: RGBLightBar pattern      *
+*                 cycle count benchmark    *
+*                                          *
+********************************************
+*/
+
+// Runs each RGBLightBar pattern for a while on a 13 LED (side bar) and an
+// 83 LED (main/rear bar) strip and counts the CPU cycles every pattern step
+// and every show() takes, using Timer1 as a cycle counter.  Meant to be run
+// under simavr by bench/avr_bench.sh, which copies the shared Carduino
+// headers in next to this file.  Results are printed on Serial, one "BENCH"
+// line per pattern and strip length.
+
+// Include libraries
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include <avr/sleep.h>
+#include "CarduinoLightBar.h"
+#include "CarduinoNanoBoards.h"
+
+// Constants
+#define BENCH_RUN_TIME 2000  // Milliseconds each pattern runs for
+#define BENCH_FRAME_TIME 30  // Same delay as the end of the Nano loop()
+#define BENCH_SHORT_DATA_PIN 6
+#define BENCH_LONG_DATA_PIN 12
+
+// One bar the length of a side bar and one the length of the main and rear bars
+typedef RGBLightBar<NANO_SIDE_BARS_BOARD.ledsPerStrip> BenchShortBar;
+typedef RGBLightBar<NANO_REAR_BAR_BOARD.ledsPerStrip> BenchLongBar;
+
+SharedClock sharedClock; // Never synced, so it runs on millis()
+PatternTimers patternTimers;
+BenchShortBar benchShortBar;
+BenchLongBar benchLongBar;
+
+// Cycle counter - Timer1 at the CPU clock, extended to 32 bits by its overflow interrupt
+volatile uint16_t timer1Overflows = 0;
+uint32_t cycleCountOverhead = 0;
+
+ISR(TIMER1_OVF_vect){
+  timer1Overflows ++;
+}
+
+uint32_t cycleCount(){
+  uint8_t oldSREG = SREG;
+  cli();
+
+  uint16_t low = TCNT1;
+  uint16_t high = timer1Overflows;
+
+  // Overflow happened but its interrupt has not run yet
+  if((TIFR1 & _BV(TOV1)) && low < 0x8000){
+    high ++;
+  }
+
+  SREG = oldSREG;
+
+  return ((uint32_t)high << 16) | low;
+}
+
+// Patterns to benchmark, called the same way updateOutputs() calls them
+template<class LightBar> void benchFlashFull(LightBar &bar){ bar.flashFull(3, yellow, white, yellow, 10); }
+template<class LightBar> void benchUpAndDown(LightBar &bar){ bar.upAndDown(3, yellow, white, yellow, 10); }
+template<class LightBar> void benchLeftAndRight(LightBar &bar){ bar.leftAndRight(3, yellow, white, yellow, 10); }
+template<class LightBar> void benchCrissCross(LightBar &bar){ bar.crissCross(3, yellow, white, yellow, 10); }
+template<class LightBar> void benchEveryOther(LightBar &bar){ bar.everyOther(3, yellow, white, yellow, 10); }
+template<class LightBar> void benchAroundTheWorld(LightBar &bar){ bar.aroundTheWorld(3, yellow, white, yellow, 7); }
+template<class LightBar> void benchRainbow(LightBar &bar){ bar.rainbow(0); }
+template<class LightBar> void benchHazard(LightBar &bar){ bar.hazardPatternRearBar(1); }
+
+// Each bar length is its own class, so every pattern has a step for each
+struct BenchPattern {
+  const char *name;
+  void (*shortStep)(BenchShortBar &bar);
+  void (*longStep)(BenchLongBar &bar);
+};
+
+#define BENCH_PATTERN(name, step) {name, step<BenchShortBar>, step<BenchLongBar>}
+
+const BenchPattern benchPatterns[] = {
+  BENCH_PATTERN("flashFull", benchFlashFull),
+  BENCH_PATTERN("upAndDown", benchUpAndDown),
+  BENCH_PATTERN("leftAndRight", benchLeftAndRight),
+  BENCH_PATTERN("crissCross", benchCrissCross),
+  BENCH_PATTERN("everyOther", benchEveryOther),
+  BENCH_PATTERN("aroundTheWorld", benchAroundTheWorld),
+  BENCH_PATTERN("rainbow", benchRainbow),
+  BENCH_PATTERN("hazardPatternRearBar", benchHazard)
+};
+
+template<class LightBar>
+void runPattern(const char *name, void (*step)(LightBar &bar), LightBar &bar, byte numLeds){
+  unsigned long steps = 0;
+  unsigned long totalCycles = 0;
+  uint32_t minCycles = 0xFFFFFFFF;
+  uint32_t maxCycles = 0;
+  uint32_t maxShowCycles = 0;
+
+  // Start every pattern from a dark bar
+  bar.solidColor(off);
+  bar.runUpdates();
+
+  unsigned long startTime = millis();
+  while(millis() - startTime < BENCH_RUN_TIME){
+    patternTimers.tick(sharedClock.now());
+
+    uint32_t stepStart = cycleCount();
+    step(bar);
+    uint32_t stepEnd = cycleCount();
+    bar.runUpdates();
+    uint32_t showEnd = cycleCount();
+
+    uint32_t stepCycles = stepEnd - stepStart - cycleCountOverhead;
+    uint32_t showCycles = showEnd - stepEnd - cycleCountOverhead;
+
+    steps ++;
+    totalCycles += stepCycles;
+    if(stepCycles < minCycles){
+      minCycles = stepCycles;
+    }
+    if(stepCycles > maxCycles){
+      maxCycles = stepCycles;
+    }
+    if(showCycles > maxShowCycles){
+      maxShowCycles = showCycles;
+    }
+
+    delay(BENCH_FRAME_TIME);
+  }
+
+  // BENCH <pattern> <leds> <steps> <min> <avg> <max> <max show>
+  Serial.print(F("BENCH "));
+  Serial.print(name);
+  Serial.print(' ');
+  Serial.print(numLeds);
+  Serial.print(' ');
+  Serial.print(steps);
+  Serial.print(' ');
+  Serial.print(minCycles);
+  Serial.print(' ');
+  Serial.print(totalCycles / steps);
+  Serial.print(' ');
+  Serial.print(maxCycles);
+  Serial.print(' ');
+  Serial.println(maxShowCycles);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  patternTimers.begin(sharedClock.now());
+  benchShortBar.begin(BENCH_SHORT_DATA_PIN, 255);
+  benchLongBar.begin(BENCH_LONG_DATA_PIN, 255);
+
+  // Take Timer1 away from analogWrite() and run it at the CPU clock
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TCNT1 = 0;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 = _BV(TOIE1);
+
+  // Cost of the two cycleCount() calls around an empty step
+  uint32_t calibrateStart = cycleCount();
+  uint32_t calibrateEnd = cycleCount();
+  cycleCountOverhead = calibrateEnd - calibrateStart;
+
+  Serial.print(F("BENCH_CPU "));
+  Serial.println(F_CPU);
+
+  for(size_t p = 0; p < sizeof(benchPatterns) / sizeof(benchPatterns[0]); p++){
+    runPattern(benchPatterns[p].name, benchPatterns[p].shortStep, benchShortBar, NANO_SIDE_BARS_BOARD.ledsPerStrip);
+    runPattern(benchPatterns[p].name, benchPatterns[p].longStep, benchLongBar, NANO_REAR_BAR_BOARD.ledsPerStrip);
+  }
+
+  Serial.println(F("BENCH_DONE"));
+  Serial.flush();
+
+  // simavr stops when the CPU sleeps with interrupts off
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+}
+
+void loop() {
+}
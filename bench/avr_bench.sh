@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# Cycle count benchmarks on the real AVR parts.  Builds a sketch from bench/
+# with arduino-cli and runs it under simavr.
+#
+#   PatternBench - every RGBLightBar pattern (default)
+#   InputBench   - reading the 74HC165 input chain, Mega only
+#
+# Usage: bench/avr_bench.sh [nano|mega] [build directory] [PatternBench|InputBench]
+#
+# Needs arduino-cli with the arduino:avr core and the Adafruit NeoPixel
+# library installed, and simavr on the PATH.
+
+set -e
+
+BOARD=${1:-nano}
+BUILD_DIR=${2:-build/avr_bench}
+BENCH=${3:-PatternBench}
+REPO_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+case "$BOARD" in
+  nano)
+    FQBN=arduino:avr:nano
+    MCU=atmega328p
+    ;;
+  mega)
+    FQBN=arduino:avr:mega:cpu=atmega2560
+    MCU=atmega2560
+    ;;
+  *)
+    echo "usage: $0 [nano|mega] [build directory] [PatternBench|InputBench]" >&2
+    exit 1
+    ;;
+esac
+
+case "$BENCH" in
+  PatternBench) ;;
+  InputBench)
+    if [ "$BOARD" != mega ]; then
+      echo "InputBench uses the Mega's input chain pins, run it on the mega" >&2
+      exit 1
+    fi
+    ;;
+  *)
+    echo "usage: $0 [nano|mega] [build directory] [PatternBench|InputBench]" >&2
+    exit 1
+    ;;
+esac
+
+# arduino-cli wants the sketch in a folder of the same name, with everything it includes next to it
+SKETCH_DIR="$BUILD_DIR/$BOARD/$BENCH"
+OUTPUT_DIR="$BUILD_DIR/$BOARD/out/$BENCH"
+mkdir -p "$SKETCH_DIR" "$OUTPUT_DIR"
+cp "$REPO_DIR/bench/$BENCH/$BENCH.ino" "$REPO_DIR/bench/$BENCH/$BENCH.cpp" "$SKETCH_DIR/"
+cp "$REPO_DIR"/Carduino*.h "$SKETCH_DIR/"
+
+arduino-cli compile --fqbn "$FQBN" --output-dir "$OUTPUT_DIR" "$SKETCH_DIR"
+
+simavr -m "$MCU" -f 16000000 "$OUTPUT_DIR/$BENCH.ino.elf" 2>&1 | awk -v bench="$BENCH" '
+  /BENCH_CPU/ {
+    cpu = $2
+    frame = cpu * 30 / 1000 # Cycles in one 30 ms Nano frame
+    if(bench == "InputBench"){
+      printf "%-12s %6s %10s %10s %10s %10s\n", "reader", "reads", "min", "avg", "max", "avg us"
+    } else {
+      printf "%-22s %5s %6s %10s %10s %10s %10s %8s\n", "pattern", "LEDs", "steps", "min", "avg", "max", "max show", "% frame"
+    }
+    next
+  }
+  /BENCH_READ / {
+    sub(/.*BENCH_READ /, "")
+    printf "%-12s %6d %10d %10d %10d %10.1f\n", $1, $2, $3, $4, $5, $4 * 1000000 / cpu
+    next
+  }
+  /BENCH_DONE/ { done = 1; next }
+  /BENCH / {
+    sub(/.*BENCH /, "")
+    printf "%-22s %5d %6d %10d %10d %10d %10d %7.2f%%\n", $1, $2, $3, $4, $5, $6, $7, ($6 + $7) * 100 / frame
+  }
+  END {
+    if(!done){
+      print "benchmark did not finish" > "/dev/stderr"
+      exit 1
+    }
+  }'
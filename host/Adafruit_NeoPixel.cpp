@@ -0,0 +1,216 @@
+#include "Adafruit_NeoPixel.h"
+#include "HostBoard.h"
+
+// Each data bit on an 800 KHz strip takes 1.25 us.  The strip latches after the
+// line has been held low for 50 us.
+#define NEO_BIT_TIME_NANOS 1250
+#define NEO_LATCH_TIME_MICROS 50
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t pin, neoPixelType type){
+  numLEDs = n;
+  this->pin = pin;
+  isRGBW = ((type >> 6) & 0b11) != ((type >> 4) & 0b11); // White offset == red offset means no W channel
+  pixels = (uint8_t *)calloc(n * 4, 1);
+  hostState = (HostStripState *)calloc(1, sizeof(HostStripState));
+  hostState->shownPixels = (uint8_t *)calloc(n * 4, 1);
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(){
+}
+
+void Adafruit_NeoPixel::begin(){
+  if(pin >= 0){
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+  }
+}
+
+void Adafruit_NeoPixel::show(){
+  if(!pixels){
+    return;
+  }
+
+  // Charge the time the data takes to clock out of the pin
+  uint64_t bits = (uint64_t)numLEDs * (isRGBW ? 32 : 24);
+  VirtualClock::advanceMicros((bits * NEO_BIT_TIME_NANOS) / 1000 + NEO_LATCH_TIME_MICROS);
+
+  hostState->shows ++;
+
+  // Tell the board when the lights actually look different
+  if(memcmp(hostState->shownPixels, pixels, numLEDs * 4) != 0){
+    memcpy(hostState->shownPixels, pixels, numLEDs * 4);
+    HostBoard::current()->pixelsChanged(VirtualClock::nowMicros());
+  }
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b){
+  setPixelColor(n, r, g, b, 0);
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w){
+  if(n >= numLEDs){
+    return;
+  }
+
+  if(brightness){ // Scale down while storing, as the real library does
+    r = (r * brightness) >> 8;
+    g = (g * brightness) >> 8;
+    b = (b * brightness) >> 8;
+    w = (w * brightness) >> 8;
+  }
+
+  uint8_t *p = &pixels[n * 4];
+  p[0] = r;
+  p[1] = g;
+  p[2] = b;
+  p[3] = isRGBW ? w : 0;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c){
+  setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c, (uint8_t)(c >> 24));
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count){
+  uint16_t end;
+
+  if(first >= numLEDs){
+    return;
+  }
+
+  if(count == 0){ // Fill to end of strip
+    end = numLEDs;
+  } else {
+    end = first + count;
+    if(end > numLEDs){
+      end = numLEDs;
+    }
+  }
+
+  for(uint16_t i = first; i < end; i++){
+    setPixelColor(i, c);
+  }
+}
+
+void Adafruit_NeoPixel::clear(){
+  if(pixels){
+    memset(pixels, 0, numLEDs * 4);
+  }
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t b){
+  uint8_t newBrightness = b + 1;
+
+  if(newBrightness != brightness){ // Rescale what is already in the buffer
+    uint8_t oldBrightness = brightness - 1;
+    uint16_t scale;
+
+    if(oldBrightness == 0){
+      scale = 0; // Avoid divide by 0
+    } else if(b == 255){
+      scale = 65535 / oldBrightness;
+    } else {
+      scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+    }
+
+    if(pixels){
+      for(uint16_t i = 0; i < numLEDs * 4; i++){
+        pixels[i] = (pixels[i] * scale) >> 8;
+      }
+    }
+
+    brightness = newBrightness;
+  }
+}
+
+uint8_t Adafruit_NeoPixel::getBrightness() const {
+  return brightness - 1;
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+  if(n >= numLEDs){
+    return 0;
+  }
+
+  const uint8_t *p = &pixels[n * 4];
+  if(brightness){ // Undo the brightness scaling (lossy, same as the real library)
+    return ((uint32_t)((p[3] << 8) / brightness) << 24) |
+           ((uint32_t)((p[0] << 8) / brightness) << 16) |
+           ((uint32_t)((p[1] << 8) / brightness) << 8) |
+           ((uint32_t)((p[2] << 8) / brightness));
+  }
+
+  return ((uint32_t)p[3] << 24) | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+// Hue 0-65535 around the color wheel, same math as the real library
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val){
+  uint8_t r, g, b;
+
+  hue = (hue * 1530L + 32768) / 65536;
+
+  if(hue < 510){ // Red to Green-1
+    b = 0;
+    if(hue < 255){
+      r = 255;
+      g = hue;
+    } else {
+      r = 510 - hue;
+      g = 255;
+    }
+  } else if(hue < 1020){ // Green to Blue-1
+    r = 0;
+    if(hue < 765){
+      g = 255;
+      b = hue - 510;
+    } else {
+      g = 1020 - hue;
+      b = 255;
+    }
+  } else if(hue < 1530){ // Blue to Red-1
+    g = 0;
+    if(hue < 1275){
+      r = hue - 1020;
+      b = 255;
+    } else {
+      r = 255;
+      b = 1530 - hue;
+    }
+  } else { // Last 0.5 Red
+    r = 255;
+    g = b = 0;
+  }
+
+  // Apply saturation and value to R,G,B, pack into 32-bit result
+  uint32_t v1 = 1 + val;
+  uint16_t s1 = 1 + sat;
+  uint8_t s2 = 255 - sat;
+
+  return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+         (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+         (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
+
+// Gamma 2.6 curve, the same one the real library's table was built from
+uint8_t Adafruit_NeoPixel::gamma8(uint8_t x){
+  static uint8_t table[256];
+  static boolean tableBuilt = false;
+
+  if(!tableBuilt){
+    for(int i = 0; i < 256; i++){
+      table[i] = (uint8_t)(pow(i / 255.0, 2.6) * 255.0 + 0.5);
+    }
+    tableBuilt = true;
+  }
+
+  return table[x];
+}
+
+uint32_t Adafruit_NeoPixel::gamma32(uint32_t x){
+  uint8_t *y = (uint8_t *)&x;
+
+  for(uint8_t i = 0; i < 4; i++){
+    y[i] = gamma8(y[i]);
+  }
+
+  return x;
+}
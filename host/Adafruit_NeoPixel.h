@@ -0,0 +1,100 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Stand-in for the Adafruit_NeoPixel library.  Keeps the    *
+*                 pixel buffer in memory and charges the virtual clock the  *
+*                 time a real strip takes to latch on show().               *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+#include "Arduino.h"
+
+// Color orders - same values as the real library
+#define NEO_RGB  ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_RBG  ((0 << 6) | (0 << 4) | (2 << 2) | (1))
+#define NEO_GRB  ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_GBR  ((2 << 6) | (2 << 4) | (0 << 2) | (1))
+#define NEO_BRG  ((1 << 6) | (1 << 4) | (2 << 2) | (0))
+#define NEO_BGR  ((2 << 6) | (2 << 4) | (1 << 2) | (0))
+#define NEO_RGBW ((3 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+
+// Data rates
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel {
+  private:
+    uint16_t numLEDs = 0;
+    int16_t pin = -1;
+    boolean isRGBW = false;
+    uint8_t brightness = 0; // Stored +1 like the real library, 0 = full
+    // Shared by copies of the strip the same way the real library's raw
+    // pointer is.  Never freed, so copies can outlive the original.
+    uint8_t *pixels = NULL; // 4 bytes per pixel: r, g, b, w (brightness applied)
+
+    // Host only - what the strip last latched, shared by copies like pixels is
+    struct HostStripState {
+      unsigned long shows;
+      uint8_t *shownPixels;
+    };
+    HostStripState *hostState = NULL;
+
+  public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+    Adafruit_NeoPixel();
+
+    void begin();
+    void show();
+    boolean canShow(){
+      return true;
+    }
+
+    void setPin(int16_t p){
+      pin = p;
+    }
+
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+    void setPixelColor(uint16_t n, uint32_t c);
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+    void clear();
+    void setBrightness(uint8_t b);
+    uint8_t getBrightness() const;
+    uint32_t getPixelColor(uint16_t n) const;
+
+    uint16_t numPixels() const {
+      return numLEDs;
+    }
+
+    int16_t getPin() const {
+      return pin;
+    }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b){
+      return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w){
+      return ((uint32_t)w << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+    static uint8_t gamma8(uint8_t x);
+    static uint32_t gamma32(uint32_t x);
+
+    // Host only - number of times show() has been called on this strip (or a copy of it)
+    unsigned long hostShowCount() const {
+      return hostState ? hostState->shows : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "Arduino.h"
+#include "HostBoard.h"
+
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+// --Digital I/O--
+
+void pinMode(uint8_t pin, uint8_t mode){
+  HostBoard::current()->pinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+  HostBoard::current()->digitalWrite(pin, value);
+}
+
+int digitalRead(uint8_t pin){
+  return HostBoard::current()->digitalRead(pin);
+}
+
+// Same bit banging as the Arduino core so the pin traffic matches the hardware
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder){
+  uint8_t value = 0;
+
+  for(uint8_t i = 0; i < 8; i++){
+    digitalWrite(clockPin, HIGH);
+    if(bitOrder == LSBFIRST){
+      value |= digitalRead(dataPin) << i;
+    } else {
+      value |= digitalRead(dataPin) << (7 - i);
+    }
+    digitalWrite(clockPin, LOW);
+  }
+
+  return value;
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value){
+  for(uint8_t i = 0; i < 8; i++){
+    if(bitOrder == LSBFIRST){
+      digitalWrite(dataPin, !!(value & (1 << i)));
+    } else {
+      digitalWrite(dataPin, !!(value & (1 << (7 - i))));
+    }
+    digitalWrite(clockPin, HIGH);
+    digitalWrite(clockPin, LOW);
+  }
+}
+
+void hostSetPinInput(uint8_t pin, uint8_t value){
+  HostBoard::current()->setPinInput(pin, value);
+}
+
+uint8_t hostGetPinOutput(uint8_t pin){
+  return HostBoard::current()->pinOutput(pin);
+}
+
+void hostSetAnalogInput(uint8_t channel, uint16_t value){
+  HostBoard::current()->setAnalogInput(channel, value);
+}
+
+uint16_t hostReadAnalogInput(uint8_t channel){
+  return HostBoard::current()->analogInput(channel);
+}
+
+// --Interrupts--
+
+static void hostRaiseTimerInterrupt(HostBoard *board, uint64_t dueMicros, unsigned long periodMicros, void (*handler)()){
+  board->raiseInterrupt(dueMicros, [board, dueMicros, periodMicros, handler](){
+    hostRaiseTimerInterrupt(board, dueMicros + periodMicros, periodMicros, handler); // Timers keep their own time, however late the handler runs
+    handler();
+  });
+}
+
+void hostAttachTimerInterrupt(unsigned long periodMicros, void (*handler)()){
+  hostRaiseTimerInterrupt(HostBoard::current(), VirtualClock::nowMicros() + periodMicros, periodMicros, handler);
+}
+
+// --Time--
+
+unsigned long millis(){
+  return (unsigned long)(VirtualClock::nowMicros() / 1000);
+}
+
+unsigned long micros(){
+  return (unsigned long)VirtualClock::nowMicros();
+}
+
+void delay(unsigned long ms){
+  VirtualClock::advanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us){
+  VirtualClock::advanceMicros(us);
+}
+
+// --Random numbers--
+
+// Park-Miller minimal standard generator, the same one avr-libc uses for random()
+static long nextRandom(){
+  unsigned long &randomState = HostBoard::current()->randomState;
+  long hi, lo, x;
+
+  x = (long)(randomState % 0x7ffffffe) + 1;
+  hi = x / 127773;
+  lo = x % 127773;
+  x = 16807 * lo - 2836 * hi;
+  if(x < 0){
+    x += 0x7fffffff;
+  }
+  randomState = (unsigned long)(x - 1);
+
+  return x - 1;
+}
+
+long random(long howBig){
+  if(howBig == 0){
+    return 0;
+  }
+  return nextRandom() % howBig;
+}
+
+long random(long howSmall, long howBig){
+  if(howSmall >= howBig){
+    return howSmall;
+  }
+  return random(howBig - howSmall) + howSmall;
+}
+
+void randomSeed(unsigned long seed){
+  if(seed != 0){
+    HostBoard::current()->randomState = seed;
+  }
+}
+
+// --Serial--
+
+void HardwareSerial::begin(unsigned long baud){
+  (void)baud;
+  started = true;
+}
+
+void HardwareSerial::end(){
+  started = false;
+}
+
+void HardwareSerial::flush(){
+  fflush(stdout);
+}
+
+void HardwareSerial::printNumber(unsigned long number, int base){
+  char buffer[8 * sizeof(unsigned long) + 1];
+  char *text = &buffer[sizeof(buffer) - 1];
+
+  if(base < 2){
+    base = 10;
+  }
+
+  *text = '\0';
+  do {
+    unsigned long digit = number % base;
+    number /= base;
+    *--text = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while(number);
+
+  fputs(text, stdout);
+}
+
+void HardwareSerial::print(const char text[]){
+  if(started){
+    fputs(text, stdout);
+  }
+}
+
+void HardwareSerial::print(char character){
+  if(started){
+    fputc(character, stdout);
+  }
+}
+
+void HardwareSerial::print(unsigned char number, int base){
+  print((unsigned long)number, base);
+}
+
+void HardwareSerial::print(int number, int base){
+  print((long)number, base);
+}
+
+void HardwareSerial::print(unsigned int number, int base){
+  print((unsigned long)number, base);
+}
+
+void HardwareSerial::print(long number, int base){
+  if(started){
+    if(base == DEC && number < 0){
+      fputc('-', stdout);
+      printNumber((unsigned long)-number, base);
+    } else {
+      printNumber((unsigned long)number, base);
+    }
+  }
+}
+
+void HardwareSerial::print(unsigned long number, int base){
+  if(started){
+    printNumber(number, base);
+  }
+}
+
+void HardwareSerial::print(double number, int digits){
+  if(started){
+    printf("%.*f", digits, number);
+  }
+}
+
+void HardwareSerial::println(){
+  print("\r\n");
+}
+
+void HardwareSerial::println(const char text[]){
+  print(text);
+  println();
+}
+
+void HardwareSerial::println(char character){
+  print(character);
+  println();
+}
+
+void HardwareSerial::println(unsigned char number, int base){
+  print(number, base);
+  println();
+}
+
+void HardwareSerial::println(int number, int base){
+  print(number, base);
+  println();
+}
+
+void HardwareSerial::println(unsigned int number, int base){
+  print(number, base);
+  println();
+}
+
+void HardwareSerial::println(long number, int base){
+  print(number, base);
+  println();
+}
+
+void HardwareSerial::println(unsigned long number, int base){
+  print(number, base);
+  println();
+}
+
+void HardwareSerial::println(double number, int digits){
+  print(number, digits);
+  println();
+}
@@ -0,0 +1,130 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Stand-in for the Arduino core so the sketches compile and *
+*                 run on a PC.  Only the parts the sketches use are here.   *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "VirtualClock.h"
+
+// Types
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+// Pin levels and modes
+#define LOW          0x0
+#define HIGH         0x1
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+// Bit orders for shiftIn()/shiftOut()
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+// Number bases for Serial.print()
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Bit helpers
+#define bit(b) (1UL << (b))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define _BV(bit) (1 << (bit))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt))) // min()/max() are left out, they would clash with the C++ library
+
+// Strings stay in RAM on the host, there is no separate flash address space
+#define F(string) (string)
+
+// Digital I/O - pins, like random() state, belong to the board the calling
+// thread is running (see HostBoard.h).  A sketch run on its own gets a default board.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t value);
+
+// Time - all driven by the VirtualClock.  Note that unsigned long is 64 bits on
+// the host, so millis() rollover math does not behave the way it does on AVR.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Interrupts - there is nothing to mask on the host
+inline void noInterrupts(){}
+inline void interrupts(){}
+
+// Host only - stand-in for a timer compare interrupt.  handler runs on the
+// calling board every periodMicros of virtual time, whenever the board's
+// pending interrupts are run.
+void hostAttachTimerInterrupt(unsigned long periodMicros, void (*handler)());
+
+// Random numbers - same call signatures as the Arduino core.  These overload the
+// C library random(void), which is left alone.
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// Host only - drive an input pin from outside the sketch
+void hostSetPinInput(uint8_t pin, uint8_t value);
+// Host only - read back the last value written to an output pin
+uint8_t hostGetPinOutput(uint8_t pin);
+// Host only - the voltage on an ADC channel, as a 10 bit reading, and the
+// reading a conversion of that channel would give
+void hostSetAnalogInput(uint8_t channel, uint16_t value);
+uint16_t hostReadAnalogInput(uint8_t channel);
+
+// Serial port - prints to stdout once begin() has been called
+class HardwareSerial {
+  private:
+    boolean started = false;
+
+    void printNumber(unsigned long number, int base);
+
+  public:
+    void begin(unsigned long baud);
+    void end();
+    void flush();
+
+    void print(const char text[]);
+    void print(char character);
+    void print(unsigned char number, int base = DEC);
+    void print(int number, int base = DEC);
+    void print(unsigned int number, int base = DEC);
+    void print(long number, int base = DEC);
+    void print(unsigned long number, int base = DEC);
+    void print(double number, int digits = 2);
+
+    void println();
+    void println(const char text[]);
+    void println(char character);
+    void println(unsigned char number, int base = DEC);
+    void println(int number, int base = DEC);
+    void println(unsigned int number, int base = DEC);
+    void println(long number, int base = DEC);
+    void println(unsigned long number, int base = DEC);
+    void println(double number, int digits = 2);
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,251 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Runs the Mega and all three Nanos together on a timed     *
+*                 I2C bus and measures how long it takes from flipping a    *
+*                 switch on the overhead panel to the light bars changing.  *
+*                                                                           *
+*    Usage: carduino_sim [I2C clock Hz]                                     *
+*           The clock defaults to 100000 (standard mode); pass 400000 for   *
+*           fast mode.                                                      *
+*                                                                           *
+*****************************************************************************
+*/
+
+#include "HostShiftRegister165.h"
+#include "HostSimulator.h"
+#include "VirtualClock.h"
+#include "sim/SimBoards.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Overhead panel 74HC165 chain, same pins as the Mega sketch
+#define SIM_LOAD_PIN     23
+#define SIM_CLK_ENAB_PIN 25
+#define SIM_DATA_IN_PIN  27
+#define SIM_CLK_IN_PIN   29
+#define SIM_NUM_CHIPS    4
+
+#define SIM_NUM_NANOS 3
+
+#define SIM_SETTLE_TIME  2000000 // Mega setup() waits a second for the Nanos, give it two
+#define SIM_TIMEOUT      1000000 // Give up on a Nano that has not changed after this long
+#define SIM_STEP_SPACING 1500000 // Time between switch flips
+
+// One switch flip.  Only flips that start with every bar sitting still are
+// measured, otherwise a running pattern's next frame would count as the response.
+struct SimStep {
+  const char *name;
+  uint8_t input;  // Index into the Mega's currentShiftInput[]
+  bool value;
+  bool measure;
+};
+
+const SimStep simSteps[] = {
+  {"Main Light Bar ON",   2,  true,  true},
+  {"Main Light Bar OFF",  2,  false, true},
+  {"Rear Light Bar ON",   6,  true,  true},
+  {"Rear Light Bar OFF",  6,  false, true},
+  {"Side Light Bars ON",  4,  true,  true},
+  {"Side Light Bars OFF", 4,  false, true},
+  {"Off Road ON",         19, true,  true},
+  {"Off Road OFF",        19, false, false},
+  {"Hazard ON",           18, true,  true},
+  {"Hazard OFF",          18, false, false},
+};
+
+// A change the HUD has to show, checked by the color of one indicator pixel
+// once the Mega has had time to act on it.  The light sensor steps move the
+// AUTO night decision, which changes the base color of every indicator.
+#define SIM_LIGHT_SENSOR 255 // Step sets the Mega's light sensor reading instead of a panel input
+#define SIM_LIGHT_SENSOR_CHANNEL 0
+#define SIM_DAYLIGHT 1023
+#define SIM_DARK 0
+
+#define SIM_HUD_MAIN_LIGHT_BAR 1 // Indicator pixels
+#define SIM_HUD_GMRS_RADIO     4
+#define SIM_HUD_NIGHT_SIGNAL   6
+
+#define SIM_HUD_GREEN  0x0000ff00 // As the Mega's Color(r, g, b, w)
+#define SIM_HUD_WHITE  0xff000000
+#define SIM_HUD_RED    0x00ff0000
+#define SIM_HUD_ORANGE 0x00ffa500
+
+struct SimHudStep {
+  const char *name;
+  uint8_t input;   // Index into the Mega's currentShiftInput[], or SIM_LIGHT_SENSOR
+  uint16_t value;  // Input state, or the 10 bit light sensor reading
+  uint8_t pixel;   // HUD indicator pixel to check
+  uint32_t color;  // Color it should show, before the HUD brightness
+};
+
+const SimHudStep simHudSteps[] = {
+  {"Daylight",                SIM_LIGHT_SENSOR, SIM_DAYLIGHT, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_WHITE},
+  {"Main Light Bar ON",       2,  1, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_GREEN},
+  {"GMRS Radio ON",           8,  1, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_GREEN},
+  {"GMRS Radio OFF",          8,  0, SIM_HUD_GMRS_RADIO,     SIM_HUD_WHITE},
+  {"Night Signal AUTO",       13, 1, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_GREEN},
+  {"Dusk",                    SIM_LIGHT_SENSOR, SIM_DARK, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_GREEN},
+  {"Main Light Bar OFF",      2,  0, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_RED},
+  {"Dawn",                    SIM_LIGHT_SENSOR, SIM_DAYLIGHT, SIM_HUD_NIGHT_SIGNAL, SIM_HUD_ORANGE},
+  {"Night Signal OFF",        13, 0, SIM_HUD_MAIN_LIGHT_BAR, SIM_HUD_WHITE},
+};
+
+// A bar that misses a frame has to be sent the scene again once it is back,
+// not have it suppressed because the general call was acknowledged by the
+// other bars.  The rear bar is unplugged while its main lights (a direct
+// frame it NACKs) and Off Road (a general call the others acknowledge) turn
+// on, plugged back in, and the Night Signal AUTO flip that follows has to
+// start its pattern.
+#define SIM_LOST_BAR 1 // nanos[] position of the rear bar
+#define SIM_LOST_BAR_ADDRESS 9
+#define SIM_LOST_BAR_INPUT 6
+#define SIM_OFF_ROAD_INPUT 19
+#define SIM_NIGHT_SIGNAL_AUTO_INPUT 13
+
+// Same color with the HUD brightness applied and taken off again - the same
+// channels are lit, but the levels can be a little off after dimming
+bool simSameColor(uint32_t pixel, uint32_t color){
+  uint32_t lit = 0;
+
+  for(int shift = 0; shift < 32; shift += 8){
+    if((color >> shift) & 0xff){
+      lit |= 0xffUL << shift;
+    }
+  }
+
+  return pixel != 0 && (pixel & ~lit) == 0;
+}
+
+int main(int argc, char **argv){
+  uint32_t busClock = 100000;
+
+  if(argc > 1){
+    busClock = strtoul(argv[1], NULL, 10);
+  }
+  if(busClock == 0){
+    fprintf(stderr, "usage: %s [I2C clock Hz]\n", argv[0]);
+    return 1;
+  }
+
+  HostSimulator simulator;
+  simulator.bus().setClock(busClock);
+
+  HostBoard *mega = simulator.addBoard("Main Mega", simMainMega::setup, simMainMega::loop);
+  HostBoard *nanos[SIM_NUM_NANOS];
+  nanos[0] = simulator.addBoard("Main Bar", simNano1::setup, simNano1::loop);
+  nanos[1] = simulator.addBoard("Rear Bar", simNano2::setup, simNano2::loop);
+  nanos[2] = simulator.addBoard("Side Bars", simNano3::setup, simNano3::loop);
+
+  HostShiftRegister165 panel(mega, SIM_LOAD_PIN, SIM_CLK_ENAB_PIN, SIM_DATA_IN_PIN, SIM_CLK_IN_PIN, SIM_NUM_CHIPS);
+
+  simulator.runUntil(SIM_SETTLE_TIME);
+
+  printf("I2C bus at %lu Hz - latency from switch flip to first pixel change\n", (unsigned long)busClock);
+  printf("%-22s", "Step");
+  for(int n = 0; n < SIM_NUM_NANOS; n++){
+    printf("%12s", nanos[n]->name());
+  }
+  printf("\n");
+
+  for(size_t s = 0; s < sizeof(simSteps) / sizeof(simSteps[0]); s++){
+    const SimStep &step = simSteps[s];
+    unsigned long changesBefore[SIM_NUM_NANOS];
+
+    for(int n = 0; n < SIM_NUM_NANOS; n++){
+      changesBefore[n] = nanos[n]->pixelChangeCount();
+    }
+
+    uint64_t flipTime = VirtualClock::nowMicros();
+    panel.setInput(step.input, step.value);
+
+    if(step.measure){
+      // Run in small slices so the first change on each Nano is caught before a later one replaces it
+      uint64_t firstChange[SIM_NUM_NANOS];
+      int waiting = SIM_NUM_NANOS;
+
+      for(int n = 0; n < SIM_NUM_NANOS; n++){
+        firstChange[n] = 0;
+      }
+
+      while(waiting > 0 && VirtualClock::nowMicros() < flipTime + SIM_TIMEOUT){
+        simulator.runFor(100);
+
+        for(int n = 0; n < SIM_NUM_NANOS; n++){
+          if(!firstChange[n] && nanos[n]->pixelChangeCount() != changesBefore[n]){
+            firstChange[n] = nanos[n]->lastPixelChange();
+            waiting --;
+          }
+        }
+      }
+
+      printf("%-22s", step.name);
+      for(int n = 0; n < SIM_NUM_NANOS; n++){
+        if(firstChange[n]){
+          printf("%9.3f ms", (firstChange[n] - flipTime) / 1000.0);
+        } else {
+          printf("%12s", "-");
+        }
+      }
+      printf("\n");
+    }
+
+    simulator.runUntil(flipTime + SIM_STEP_SPACING);
+  }
+
+  HostI2CBus &bus = simulator.bus();
+  printf("\nI2C: %lu transactions, %lu NACKs, %lu data bytes, bus busy %.3f ms of %.3f ms\n",
+         bus.transactionCount(), bus.nackCount(), bus.byteCount(),
+         bus.busyTime() / 1000.0, VirtualClock::nowMicros() / 1000.0);
+  printf("Mega: %u commands suppressed, the lights were already that way\n", simMainMega::checkSuppressedI2CCommands());
+
+  printf("\n%-22s%12s%12s\n", "HUD check", "Pixel", "Color");
+  int hudFailures = 0;
+
+  for(size_t s = 0; s < sizeof(simHudSteps) / sizeof(simHudSteps[0]); s++){
+    const SimHudStep &step = simHudSteps[s];
+
+    if(step.input == SIM_LIGHT_SENSOR){
+      mega->setAnalogInput(SIM_LIGHT_SENSOR_CHANNEL, step.value);
+    } else {
+      panel.setInput(step.input, step.value);
+    }
+    simulator.runFor(SIM_STEP_SPACING);
+
+    uint32_t pixel = simMainMega::hudPixel(step.pixel);
+    bool pass = simSameColor(pixel, step.color);
+
+    printf("%-22s%12u    %08lx %s\n", step.name, step.pixel, (unsigned long)pixel, pass ? "ok" : "WRONG");
+    if(!pass){
+      hudFailures ++;
+    }
+  }
+
+  printf("\n%-22s%12s%12s\n", "Lost frame check", "NACKs", "Pattern");
+
+  unsigned long nacksBefore = bus.nackCount();
+  bus.setConnected(SIM_LOST_BAR_ADDRESS, false);
+  panel.setInput(SIM_LOST_BAR_INPUT, true);
+  simulator.runFor(SIM_STEP_SPACING);
+  panel.setInput(SIM_OFF_ROAD_INPUT, true);
+  simulator.runFor(SIM_STEP_SPACING);
+  bus.setConnected(SIM_LOST_BAR_ADDRESS, true);
+
+  unsigned long lostNacks = bus.nackCount() - nacksBefore;
+  unsigned long changesBefore = nanos[SIM_LOST_BAR]->pixelChangeCount();
+  panel.setInput(SIM_NIGHT_SIGNAL_AUTO_INPUT, true);
+  simulator.runFor(SIM_STEP_SPACING);
+
+  bool lostBarResent = nanos[SIM_LOST_BAR]->pixelChangeCount() != changesBefore;
+  printf("%-22s%12lu%12s %s\n", nanos[SIM_LOST_BAR]->name(), lostNacks, lostBarResent ? "running" : "still", lostBarResent ? "ok" : "WRONG");
+
+  panel.setInput(SIM_NIGHT_SIGNAL_AUTO_INPUT, false);
+  panel.setInput(SIM_OFF_ROAD_INPUT, false);
+  panel.setInput(SIM_LOST_BAR_INPUT, false);
+  simulator.runFor(SIM_STEP_SPACING);
+
+  return (hudFailures || !lostBarResent) ? 1 : 0;
+}
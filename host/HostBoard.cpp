@@ -0,0 +1,137 @@
+#include "HostBoard.h"
+
+#include <string.h>
+
+// Pin levels and modes, the same values as Arduino.h
+#define HOST_LOW          0x0
+#define HOST_HIGH         0x1
+#define HOST_OUTPUT       0x1
+#define HOST_INPUT_PULLUP 0x2
+
+// Used when a sketch runs on its own without the simulator
+static HostBoard defaultBoard("board");
+static thread_local HostBoard *currentBoard = &defaultBoard;
+
+HostBoard::HostBoard(const char *boardName){
+  this->boardName = boardName;
+  memset(pinModes, 0, sizeof(pinModes));
+  memset(pinOutputs, 0, sizeof(pinOutputs));
+  memset(pinInputs, 0, sizeof(pinInputs));
+  memset(analogInputs, 0, sizeof(analogInputs));
+}
+
+HostBoard *HostBoard::current(){
+  return currentBoard;
+}
+
+void HostBoard::setCurrent(HostBoard *board){
+  currentBoard = board ? board : &defaultBoard;
+}
+
+void HostBoard::pinMode(uint8_t pin, uint8_t mode){
+  if(pin < HOST_NUM_PINS){
+    pinModes[pin] = mode;
+    if(mode == HOST_INPUT_PULLUP){
+      pinInputs[pin] = HOST_HIGH;
+    }
+  }
+}
+
+void HostBoard::digitalWrite(uint8_t pin, uint8_t value){
+  if(pin < HOST_NUM_PINS){
+    pinOutputs[pin] = value ? HOST_HIGH : HOST_LOW;
+    for(size_t i = 0; i < pinListeners.size(); i++){
+      pinListeners[i]->pinWritten(pin, pinOutputs[pin]);
+    }
+  }
+}
+
+int HostBoard::digitalRead(uint8_t pin) const {
+  if(pin >= HOST_NUM_PINS){
+    return HOST_LOW;
+  }
+
+  if(pinModes[pin] == HOST_OUTPUT){ // Reading an output returns what was written
+    return pinOutputs[pin];
+  }
+
+  return pinInputs[pin];
+}
+
+void HostBoard::setPinInput(uint8_t pin, uint8_t value){
+  if(pin < HOST_NUM_PINS){
+    pinInputs[pin] = value ? HOST_HIGH : HOST_LOW;
+  }
+}
+
+uint8_t HostBoard::pinOutput(uint8_t pin) const {
+  if(pin < HOST_NUM_PINS){
+    return pinOutputs[pin];
+  }
+  return HOST_LOW;
+}
+
+void HostBoard::attachPinListener(HostPinListener *listener){
+  pinListeners.push_back(listener);
+}
+
+void HostBoard::setAnalogInput(uint8_t channel, uint16_t value){
+  if(channel < HOST_NUM_ANALOG_CHANNELS){
+    analogInputs[channel] = value > 1023 ? 1023 : value;
+  }
+}
+
+uint16_t HostBoard::analogInput(uint8_t channel) const {
+  if(channel >= HOST_NUM_ANALOG_CHANNELS){
+    return 0;
+  }
+  return analogInputs[channel];
+}
+
+void HostBoard::raiseInterrupt(uint64_t dueMicros, std::function<void()> handler){
+  PendingInterrupt pending;
+  pending.dueMicros = dueMicros;
+  pending.order = interruptOrder++;
+  pending.handler = handler;
+  pendingInterrupts.push_back(pending);
+}
+
+uint64_t HostBoard::nextInterruptMicros() const {
+  uint64_t next = UINT64_MAX;
+
+  for(size_t i = 0; i < pendingInterrupts.size(); i++){
+    if(pendingInterrupts[i].dueMicros < next){
+      next = pendingInterrupts[i].dueMicros;
+    }
+  }
+
+  return next;
+}
+
+void HostBoard::runDueInterrupts(uint64_t nowMicros){
+  while(true){
+    // Oldest due interrupt first
+    size_t found = pendingInterrupts.size();
+    for(size_t i = 0; i < pendingInterrupts.size(); i++){
+      if(pendingInterrupts[i].dueMicros <= nowMicros &&
+         (found == pendingInterrupts.size() ||
+          pendingInterrupts[i].dueMicros < pendingInterrupts[found].dueMicros ||
+          (pendingInterrupts[i].dueMicros == pendingInterrupts[found].dueMicros && pendingInterrupts[i].order < pendingInterrupts[found].order))){
+        found = i;
+      }
+    }
+
+    if(found == pendingInterrupts.size()){
+      return;
+    }
+
+    std::function<void()> handler = pendingInterrupts[found].handler;
+    pendingInterrupts.erase(pendingInterrupts.begin() + found);
+    handler();
+  }
+}
+
+void HostBoard::pixelsChanged(uint64_t nowMicros){
+  lastPixelChangeMicros = nowMicros;
+  pixelChanges ++;
+}
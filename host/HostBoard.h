@@ -0,0 +1,94 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: State that belongs to one simulated board - pins, random  *
+*                 number state, pending interrupts and pixel activity.      *
+*                 The Arduino core functions work on whichever board is     *
+*                 current on the calling thread.                            *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#define HOST_NUM_PINS 70 // Number of pins on the biggest board in the network (Mega 2560)
+#define HOST_NUM_ANALOG_CHANNELS 16 // ADC channels on the Mega 2560
+
+// Something wired to a board's pins, such as a shift register
+class HostPinListener {
+  public:
+    virtual ~HostPinListener(){}
+    virtual void pinWritten(uint8_t pin, uint8_t value) = 0;
+};
+
+class HostBoard {
+  private:
+    struct PendingInterrupt {
+      uint64_t dueMicros;
+      unsigned long order; // Keeps interrupts due at the same time in the order they were raised
+      std::function<void()> handler;
+    };
+
+    const char *boardName;
+
+    uint8_t pinModes[HOST_NUM_PINS];
+    uint8_t pinOutputs[HOST_NUM_PINS];
+    uint8_t pinInputs[HOST_NUM_PINS];
+    uint16_t analogInputs[HOST_NUM_ANALOG_CHANNELS];
+    std::vector<HostPinListener *> pinListeners;
+
+    std::vector<PendingInterrupt> pendingInterrupts;
+    unsigned long interruptOrder = 0;
+
+    uint64_t lastPixelChangeMicros = 0;
+    unsigned long pixelChanges = 0;
+
+  public:
+    unsigned long randomState = 1; // random() state, seeded the same as a freshly reset AVR
+
+    HostBoard(const char *boardName);
+
+    const char *name() const {
+      return boardName;
+    }
+
+    // The board the calling thread is running code for
+    static HostBoard *current();
+    static void setCurrent(HostBoard *board);
+
+    // Pins
+    void pinMode(uint8_t pin, uint8_t mode);
+    void digitalWrite(uint8_t pin, uint8_t value);
+    int digitalRead(uint8_t pin) const;
+    void setPinInput(uint8_t pin, uint8_t value);
+    uint8_t pinOutput(uint8_t pin) const;
+    void attachPinListener(HostPinListener *listener);
+
+    // Analog inputs, as the 10 bit reading the ADC would give
+    void setAnalogInput(uint8_t channel, uint16_t value);
+    uint16_t analogInput(uint8_t channel) const;
+
+    // Interrupts - handler runs on this board at the given virtual time
+    void raiseInterrupt(uint64_t dueMicros, std::function<void()> handler);
+    uint64_t nextInterruptMicros() const; // UINT64_MAX if nothing is pending
+    void runDueInterrupts(uint64_t nowMicros);
+
+    // Pixel activity, reported by the NeoPixel mock when show() sends new data
+    void pixelsChanged(uint64_t nowMicros);
+    uint64_t lastPixelChange() const {
+      return lastPixelChangeMicros;
+    }
+    unsigned long pixelChangeCount() const {
+      return pixelChanges;
+    }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "HostI2CBus.h"
+#include "HostBoard.h"
+#include "VirtualClock.h"
+#include "Wire.h"
+
+HostI2CBus *HostI2CBus::activeBus = NULL;
+
+void HostI2CBus::attach(TwoWire *device, uint8_t address, HostBoard *board){
+  Slave slave;
+  slave.address = address;
+  slave.device = device;
+  slave.board = board;
+  slave.connected = true;
+  slaves.push_back(slave);
+}
+
+void HostI2CBus::setConnected(uint8_t address, bool connected){
+  for(size_t i = 0; i < slaves.size(); i++){
+    if(slaves[i].address == address){
+      slaves[i].connected = connected;
+    }
+  }
+}
+
+uint64_t HostI2CBus::transferMicros(uint8_t quantity, uint32_t clock){
+  uint64_t bits = I2C_FRAMING_BITS + (uint64_t)I2C_BITS_PER_BYTE * (1 + quantity);
+
+  return (bits * 1000000 + clock - 1) / clock;
+}
+
+uint8_t HostI2CBus::write(uint8_t address, const uint8_t *data, uint8_t quantity, uint32_t masterClock){
+  uint32_t clock = clockOverride ? clockOverride : masterClock;
+  std::vector<Slave *> targets;
+
+  // A general call goes to every slave that has TWGCE set in its TWAR
+  for(size_t i = 0; i < slaves.size(); i++){
+    if(!slaves[i].connected){
+      continue;
+    }
+    if(address == 0 ? (slaves[i].device->hostAddressRegister() & _BV(TWGCE)) != 0 : slaves[i].address == address){
+      targets.push_back(&slaves[i]);
+    }
+  }
+
+  transactions ++;
+
+  if(targets.empty()){ // Nobody answers the address byte - START, address, NACK, STOP
+    uint64_t nackTime = transferMicros(0, clock);
+    nacks ++;
+    busyMicros += nackTime;
+    VirtualClock::advanceMicros(nackTime);
+    return 2;
+  }
+
+  uint64_t duration = transferMicros(quantity, clock);
+  std::vector<uint8_t> payload(data, data + quantity);
+
+  bytes += quantity;
+  busyMicros += duration;
+
+  // Every slave sees the message at the STOP condition
+  for(size_t i = 0; i < targets.size(); i++){
+    TwoWire *device = targets[i]->device;
+    targets[i]->board->raiseInterrupt(VirtualClock::nowMicros() + duration, [device, payload](){
+      device->hostReceive(payload.data(), (uint8_t)payload.size());
+    });
+  }
+
+  // Wire.endTransmission() does not return until the STOP has been sent
+  VirtualClock::advanceMicros(duration);
+
+  return 0;
+}
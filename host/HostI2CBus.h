@@ -0,0 +1,93 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Timed model of the I2C bus between the simulated boards.  *
+*                 A master write holds the master for as long as the bytes  *
+*                 take on the wire and hands them to the addressed slave's  *
+*                 receive handler at the STOP condition, the same moment    *
+*                 the TWI interrupt would fire on the real board.           *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_I2C_BUS_H
+#define HOST_I2C_BUS_H
+
+#include <stdint.h>
+
+#include <vector>
+
+class TwoWire;
+class HostBoard;
+
+// Bits on the wire for a write of n data bytes: START, address byte + ACK,
+// n data bytes + ACK each, STOP
+#define I2C_BITS_PER_BYTE 9
+#define I2C_FRAMING_BITS 2
+
+class HostI2CBus {
+  private:
+    struct Slave {
+      uint8_t address;
+      TwoWire *device;
+      HostBoard *board;
+      bool connected;
+    };
+
+    std::vector<Slave> slaves;
+    uint32_t clockOverride = 0; // 0 = use whatever the master asked for in Wire.setClock()
+
+    // Running totals
+    unsigned long transactions = 0;
+    unsigned long nacks = 0;
+    unsigned long bytes = 0;
+    uint64_t busyMicros = 0;
+
+    static HostI2CBus *activeBus;
+
+  public:
+    // The bus the mock Wire library talks to, NULL when a sketch runs on its own
+    static HostI2CBus *active(){
+      return activeBus;
+    }
+    static void setActive(HostI2CBus *bus){
+      activeBus = bus;
+    }
+
+    // Force every master on the bus to this clock (100000 or 400000)
+    void setClock(uint32_t clock){
+      clockOverride = clock;
+    }
+
+    // Called from Wire.begin(address) on a slave
+    void attach(TwoWire *device, uint8_t address, HostBoard *board);
+
+    // Unplug a slave from the bus or plug it back in.  An unplugged slave
+    // keeps running but answers nothing, not even a general call.
+    void setConnected(uint8_t address, bool connected);
+
+    // Master write.  Blocks the calling board for the time on the wire and returns
+    // the same status codes as Wire.endTransmission(): 0 = ACK, 2 = address NACK.
+    // Address 0 is a general call and reaches every slave that enabled it.
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t quantity, uint32_t masterClock);
+
+    // Time a write of this many data bytes takes at this clock
+    static uint64_t transferMicros(uint8_t quantity, uint32_t clock);
+
+    unsigned long transactionCount() const {
+      return transactions;
+    }
+    unsigned long nackCount() const {
+      return nacks;
+    }
+    unsigned long byteCount() const {
+      return bytes;
+    }
+    uint64_t busyTime() const {
+      return busyMicros;
+    }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "HostShiftRegister165.h"
+
+HostShiftRegister165::HostShiftRegister165(HostBoard *board, uint8_t loadPin, uint8_t clockEnablePin, uint8_t dataPin, uint8_t clockPin, uint8_t numChips){
+  this->board = board;
+  this->loadPin = loadPin;
+  this->clockEnablePin = clockEnablePin;
+  this->dataPin = dataPin;
+  this->clockPin = clockPin;
+  this->numChips = numChips;
+
+  board->attachPinListener(this);
+}
+
+void HostShiftRegister165::setInput(uint8_t input, bool value){
+  if(value){
+    inputs |= (uint64_t)1 << input;
+  } else {
+    inputs &= ~((uint64_t)1 << input);
+  }
+}
+
+void HostShiftRegister165::updateDataPin(){
+  uint8_t value = 0;
+
+  if(position < numChips * 8){
+    uint8_t input = (position / 8) * 8 + (7 - position % 8); // MSB of each byte comes out first
+    value = (latched >> input) & 1;
+  }
+
+  board->setPinInput(dataPin, value);
+}
+
+void HostShiftRegister165::pinWritten(uint8_t pin, uint8_t value){
+  if(pin == loadPin){
+    if(value == 0){ // Parallel load
+      latched = inputs;
+      position = 0;
+      updateDataPin();
+    }
+    return;
+  }
+
+  if(pin != clockPin && pin != clockEnablePin){
+    return;
+  }
+
+  uint8_t clock = board->pinOutput(clockPin) | board->pinOutput(clockEnablePin);
+
+  if(clock && !lastClock && board->pinOutput(loadPin)){ // Rising edge with PL high shifts one bit
+    position ++;
+    updateDataPin();
+  }
+
+  lastClock = clock;
+}
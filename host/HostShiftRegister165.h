@@ -0,0 +1,52 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Pin level model of a chain of 74HC165 parallel-in,        *
+*                 serial-out shift registers, the way the overhead switch   *
+*                 panel is wired to the Mega.                               *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_SHIFT_REGISTER_165_H
+#define HOST_SHIFT_REGISTER_165_H
+
+#include "HostBoard.h"
+
+// Input i of the chain is the bit the Mega's readInputs() sees at
+// currentShiftInput[i]: the first byte clocked out holds inputs 0-7, with
+// input 7 on the first clock since the sketch reads MSBFIRST.
+class HostShiftRegister165 : public HostPinListener {
+  private:
+    HostBoard *board;
+    uint8_t loadPin;      // PL - parallel load while LOW
+    uint8_t clockEnablePin; // CE - clock inhibit while HIGH
+    uint8_t dataPin;      // Q7 - serial out
+    uint8_t clockPin;     // CP - shifts on the rising edge
+    uint8_t numChips;
+
+    uint64_t inputs = 0;  // What the switches are set to now
+    uint64_t latched = 0; // What was captured at the last load
+    uint8_t position = 0; // Serial bits shifted out since the last load
+    uint8_t lastClock = 0; // CP OR CE, the chip's internal clock
+
+    void updateDataPin();
+
+  public:
+    HostShiftRegister165(HostBoard *board, uint8_t loadPin, uint8_t clockEnablePin, uint8_t dataPin, uint8_t clockPin, uint8_t numChips);
+
+    void pinWritten(uint8_t pin, uint8_t value);
+
+    // Switch positions, input i in bit i
+    void setInputs(uint64_t newInputs){
+      inputs = newInputs;
+    }
+    void setInput(uint8_t input, bool value);
+    uint64_t currentInputs() const {
+      return inputs;
+    }
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "HostSimulator.h"
+#include "VirtualClock.h"
+
+HostSimulator *HostSimulator::activeSimulator = NULL;
+thread_local HostSimulator::Slot *HostSimulator::currentSlot = NULL;
+
+HostSimulator::HostSimulator(){
+  activeSimulator = this;
+  HostI2CBus::setActive(&i2cBus);
+  VirtualClock::setSleepHandler(sleepHandler);
+}
+
+HostSimulator::~HostSimulator(){
+  // Wake every parked board so it unwinds out of its sketch
+  stopping = true;
+  for(size_t i = 0; i < slots.size(); i++){
+    if(!slots[i]->finished){
+      resume(slots[i]);
+    }
+  }
+
+  for(size_t i = 0; i < slots.size(); i++){
+    slots[i]->thread.join();
+    delete slots[i]->board;
+    delete slots[i];
+  }
+
+  VirtualClock::setSleepHandler(NULL);
+  HostI2CBus::setActive(NULL);
+  activeSimulator = NULL;
+}
+
+HostBoard *HostSimulator::addBoard(const char *name, SketchFunction setup, SketchFunction loop){
+  Slot *slot = new Slot();
+  slot->board = new HostBoard(name);
+  slot->setup = setup;
+  slot->loop = loop;
+  slot->index = (int)slots.size();
+  slot->wakeMicros = VirtualClock::nowMicros();
+  slot->finished = false;
+  slots.push_back(slot);
+
+  slot->thread = std::thread(&HostSimulator::boardMain, this, slot);
+
+  return slot->board;
+}
+
+void HostSimulator::runUntil(uint64_t endMicros){
+  while(true){
+    Slot *next = NULL;
+    uint64_t nextMicros = UINT64_MAX;
+
+    for(size_t i = 0; i < slots.size(); i++){
+      if(slots[i]->finished){
+        continue;
+      }
+
+      uint64_t due = slots[i]->wakeMicros;
+      uint64_t interrupt = slots[i]->board->nextInterruptMicros();
+      if(interrupt < due){
+        due = interrupt;
+      }
+
+      if(due < nextMicros){ // Strictly less keeps the lowest board first on a tie
+        nextMicros = due;
+        next = slots[i];
+      }
+    }
+
+    if(!next || nextMicros > endMicros){
+      VirtualClock::setMicros(endMicros);
+      return;
+    }
+
+    VirtualClock::setMicros(nextMicros);
+    resume(next);
+  }
+}
+
+void HostSimulator::runFor(uint64_t micros){
+  runUntil(VirtualClock::nowMicros() + micros);
+}
+
+// Called whenever code advances the clock
+void HostSimulator::sleepHandler(uint64_t wakeMicros){
+  if(currentSlot){
+    activeSimulator->park(currentSlot, wakeMicros);
+  } else { // The simulator's own thread just moves time
+    VirtualClock::setMicros(wakeMicros);
+  }
+}
+
+void HostSimulator::boardMain(Slot *slot){
+  waitForBaton(slot);
+
+  currentSlot = slot;
+  HostBoard::setCurrent(slot->board);
+
+  try {
+    if(stopping){
+      throw Stop();
+    }
+
+    slot->setup();
+    while(true){
+      uint64_t loopStart = VirtualClock::nowMicros();
+
+      slot->loop();
+
+      if(VirtualClock::nowMicros() == loopStart){ // Keep a loop() that never waits from holding the clock still
+        VirtualClock::advanceMicros(1);
+      }
+    }
+  } catch(Stop &){
+  }
+
+  slot->finished = true;
+  returnBaton(slot);
+}
+
+void HostSimulator::park(Slot *slot, uint64_t wakeMicros){
+  slot->wakeMicros = wakeMicros;
+
+  while(true){
+    returnBaton(slot);
+    waitForBaton(slot);
+
+    if(stopping){
+      throw Stop();
+    }
+
+    slot->board->runDueInterrupts(VirtualClock::nowMicros());
+
+    if(VirtualClock::nowMicros() >= slot->wakeMicros){
+      return;
+    }
+  }
+}
+
+// Simulator side - hand the baton to a board and wait for it to come back
+void HostSimulator::resume(Slot *slot){
+  std::unique_lock<std::mutex> lock(batonMutex);
+  running = slot->index;
+  batonChanged.notify_all();
+  batonChanged.wait(lock, [this](){ return running == -1; });
+}
+
+// Board side
+void HostSimulator::returnBaton(Slot *slot){
+  std::lock_guard<std::mutex> lock(batonMutex);
+  (void)slot;
+  running = -1;
+  batonChanged.notify_all();
+}
+
+void HostSimulator::waitForBaton(Slot *slot){
+  std::unique_lock<std::mutex> lock(batonMutex);
+  batonChanged.wait(lock, [this, slot](){ return running == slot->index; });
+}
@@ -0,0 +1,83 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Runs several sketches in one process against one shared   *
+*                 virtual clock.                                            *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_SIMULATOR_H
+#define HOST_SIMULATOR_H
+
+#include "HostBoard.h"
+#include "HostI2CBus.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Each board's sketch runs on its own thread, but only one thread runs at a
+// time.  Board code runs in zero virtual time until it advances the clock
+// (delay(), delayMicroseconds(), a NeoPixel show() or an I2C transfer).  That
+// parks the board until its wake time, and the simulator always resumes the
+// board with the earliest wake time or pending interrupt, lowest board first
+// on a tie.  The run is therefore the same every time.
+//
+// Interrupts raised on a board (I2C receive) run on that board's thread at
+// their due time, in the middle of whatever delay the board was sitting in,
+// just like the real TWI interrupt.
+class HostSimulator {
+  public:
+    typedef void (*SketchFunction)();
+
+    HostSimulator();
+    ~HostSimulator(); // Stops every board
+
+    // Boards start running their setup() at the current time on the next run
+    HostBoard *addBoard(const char *name, SketchFunction setup, SketchFunction loop);
+
+    HostI2CBus &bus(){
+      return i2cBus;
+    }
+
+    void runUntil(uint64_t endMicros);
+    void runFor(uint64_t micros);
+
+  private:
+    struct Slot {
+      HostBoard *board;
+      SketchFunction setup;
+      SketchFunction loop;
+      std::thread thread;
+      int index;
+      uint64_t wakeMicros;
+      bool finished;
+    };
+
+    // Thrown inside a parked board to unwind its sketch when the simulator stops
+    struct Stop {};
+
+    std::vector<Slot *> slots;
+    HostI2CBus i2cBus;
+
+    std::mutex batonMutex;
+    std::condition_variable batonChanged;
+    int running = -1; // Board holding the baton, -1 = the simulator itself
+    bool stopping = false;
+
+    static HostSimulator *activeSimulator;
+    static thread_local Slot *currentSlot;
+
+    static void sleepHandler(uint64_t wakeMicros);
+    void boardMain(Slot *slot);
+    void park(Slot *slot, uint64_t wakeMicros);
+    void resume(Slot *slot);
+    void returnBaton(Slot *slot);
+    void waitForBaton(Slot *slot);
+};
+
+#endif
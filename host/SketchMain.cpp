@@ -0,0 +1,76 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Entry point for running one sketch on a PC.  Calls        *
+*                 setup() once, then loop() until the requested amount of   *
+*                 virtual time has passed.                                  *
+*                                                                           *
+*    Usage: <sketch> [run time ms] [I2C pattern] [I2C option]               *
+*           The optional pattern/option are framed and handed to the        *
+*           sketch's I2C receive handler right after setup(), the same as   *
+*           the Mega sending them, so a Nano pattern can be profiled on     *
+*           its own.                                                        *
+*                                                                           *
+*****************************************************************************
+*/
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include <HostBoard.h>
+
+#include "../CarduinoProtocol.h"
+
+#include <chrono>
+#include <stdio.h>
+
+// Provided by the sketch
+void setup();
+void loop();
+
+int main(int argc, char **argv){
+  unsigned long runTime = 10000; // Virtual milliseconds to run for
+  uint8_t message[I2C_FRAME_LENGTH(1)];
+  uint8_t messageLength = 0;
+
+  if(argc > 1){
+    runTime = strtoul(argv[1], NULL, 10);
+  }
+  if(argc > 2){ // Same frame the Mega sends for a single command
+    message[1] = (uint8_t)strtoul(argv[2], NULL, 10);
+    message[2] = argc > 3 ? (uint8_t)strtoul(argv[3], NULL, 10) : I2C_NO_OPTION;
+    messageLength = i2cFrameFinish(message, 1);
+  }
+
+  std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+  setup();
+
+  if(messageLength > 0){
+    Wire.hostReceive(message, messageLength);
+  }
+
+  unsigned long loopCount = 0;
+  while(millis() < runTime){
+    uint64_t loopStart = VirtualClock::nowMicros();
+
+    loop();
+    loopCount ++;
+
+    HostBoard::current()->runDueInterrupts(VirtualClock::nowMicros());
+
+    if(VirtualClock::nowMicros() == loopStart){ // Keep a loop() that never waits from spinning forever
+      VirtualClock::advanceMicros(1);
+    }
+  }
+
+  std::chrono::steady_clock::time_point hostEnd = std::chrono::steady_clock::now();
+  double hostMicros = std::chrono::duration<double, std::micro>(hostEnd - hostStart).count();
+
+  fprintf(stderr, "%lu loop() passes in %lu ms virtual time, %.0f us host time (%.3f us per pass), %lu I2C transmissions\n",
+          loopCount, millis(), hostMicros, loopCount ? hostMicros / loopCount : 0.0, Wire.hostTransmissions());
+
+  return 0;
+}
@@ -0,0 +1,37 @@
+#include "VirtualClock.h"
+
+#include <stddef.h>
+
+// Current virtual time in microseconds
+static uint64_t currentMicros = 0;
+static VirtualClock::SleepHandler sleepHandler = NULL;
+
+uint64_t VirtualClock::nowMicros(){
+  return currentMicros;
+}
+
+void VirtualClock::advanceMicros(uint64_t micros){
+  if(sleepHandler){
+    sleepHandler(currentMicros + micros);
+  } else {
+    currentMicros += micros;
+  }
+}
+
+void VirtualClock::advanceMillis(uint64_t millis){
+  advanceMicros(millis * 1000);
+}
+
+void VirtualClock::setMicros(uint64_t micros){
+  if(micros > currentMicros){ // The clock never runs backwards
+    currentMicros = micros;
+  }
+}
+
+void VirtualClock::reset(){
+  currentMicros = 0;
+}
+
+void VirtualClock::setSleepHandler(SleepHandler handler){
+  sleepHandler = handler;
+}
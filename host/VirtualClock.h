@@ -0,0 +1,46 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Virtual clock that drives millis(), micros(), delay() and *
+*                 delayMicroseconds() when the sketches run on a PC.        *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include <stdint.h>
+
+// Time only moves when something asks it to.  delay() and delayMicroseconds()
+// advance the clock by exactly the requested amount, the NeoPixel mock charges
+// the time a real strip takes to latch, and a host program can push the clock
+// forward by hand.  Nothing here reads the wall clock, so a run is repeatable.
+//
+// When several boards run together, the simulator installs a sleep handler.
+// Advancing the clock from board code then parks that board until the
+// simulator has brought the shared clock up to its wake time.
+class VirtualClock {
+  public:
+    typedef void (*SleepHandler)(uint64_t wakeMicros);
+
+    // Current time in microseconds since the clock was reset
+    static uint64_t nowMicros();
+
+    // Move the clock forward
+    static void advanceMicros(uint64_t micros);
+    static void advanceMillis(uint64_t millis);
+
+    // Jump straight to a time.  Going backwards is ignored.
+    static void setMicros(uint64_t micros);
+
+    // Back to 0 for a fresh run
+    static void reset();
+
+    // NULL for a single sketch, where advancing just adds to the clock
+    static void setSleepHandler(SleepHandler handler);
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "Wire.h"
+#include "HostBoard.h"
+#include "HostI2CBus.h"
+
+TwoWire Wire;
+
+void TwoWire::begin(){
+  ownAddress = 0;
+}
+
+void TwoWire::begin(uint8_t address){
+  ownAddress = address;
+  addressRegister = address << 1;
+
+  if(HostI2CBus::active()){ // Answer this address on the simulated bus
+    HostI2CBus::active()->attach(this, address, HostBoard::current());
+  }
+}
+
+void TwoWire::setClock(uint32_t clock){
+  clockSpeed = clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address){
+  txAddress = address;
+  txLength = 0;
+}
+
+// With no bus attached every transmission is treated as acknowledged
+uint8_t TwoWire::endTransmission(bool sendStop){
+  uint8_t status = 0;
+
+  (void)sendStop;
+
+  if(HostI2CBus::active()){
+    status = HostI2CBus::active()->write(txAddress, txBuffer, txLength, clockSpeed);
+  }
+
+  transmissions ++;
+  bytesSent += txLength;
+  txLength = 0;
+
+  return status;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity){
+  (void)address;
+  (void)quantity;
+
+  // No slave on the other end - nothing comes back
+  rxIndex = 0;
+  rxLength = 0;
+
+  return 0;
+}
+
+size_t TwoWire::write(uint8_t data){
+  if(txLength >= BUFFER_LENGTH){
+    return 0;
+  }
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity){
+  size_t written = 0;
+
+  while(written < quantity && write(data[written])){
+    written ++;
+  }
+
+  return written;
+}
+
+int TwoWire::available(){
+  return rxLength - rxIndex;
+}
+
+int TwoWire::read(){
+  if(rxIndex >= rxLength){
+    return -1;
+  }
+  return rxBuffer[rxIndex++];
+}
+
+int TwoWire::peek(){
+  if(rxIndex >= rxLength){
+    return -1;
+  }
+  return rxBuffer[rxIndex];
+}
+
+void TwoWire::onReceive(void (*function)(int)){
+  receiveHandler = function;
+}
+
+void TwoWire::onRequest(void (*function)(void)){
+  requestHandler = function;
+}
+
+void TwoWire::hostReceive(const uint8_t *data, uint8_t quantity){
+  if(quantity > BUFFER_LENGTH){
+    quantity = BUFFER_LENGTH;
+  }
+
+  memcpy(rxBuffer, data, quantity);
+  rxIndex = 0;
+  rxLength = quantity;
+
+  if(receiveHandler){
+    receiveHandler(quantity);
+  }
+}
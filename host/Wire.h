@@ -0,0 +1,86 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Stand-in for the Arduino Wire (I2C) library.              *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+// TWI slave address register.  Wire.begin(address) loads it with the address
+// shifted up one bit; setting TWGCE as well makes the device answer general
+// call (address 0) writes.  On the host it belongs to the sketch's Wire.
+#define TWGCE 0
+#define TWAR (Wire.hostAddressRegister())
+
+class TwoWire {
+  private:
+    uint8_t ownAddress = 0; // 0 = master
+    uint8_t addressRegister = 0; // TWAR
+    uint32_t clockSpeed = 100000;
+
+    // Transmit side
+    uint8_t txAddress = 0;
+    uint8_t txBuffer[BUFFER_LENGTH];
+    uint8_t txLength = 0;
+
+    // Receive side
+    uint8_t rxBuffer[BUFFER_LENGTH];
+    uint8_t rxIndex = 0;
+    uint8_t rxLength = 0;
+
+    void (*receiveHandler)(int) = NULL;
+    void (*requestHandler)(void) = NULL;
+
+    // Host only - running totals
+    unsigned long transmissions = 0;
+    unsigned long bytesSent = 0;
+
+  public:
+    void begin();
+    void begin(uint8_t address);
+    void setClock(uint32_t clock);
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+
+    size_t write(uint8_t data);
+    size_t write(const uint8_t *data, size_t quantity);
+    int available();
+    int read();
+    int peek();
+
+    void onReceive(void (*function)(int));
+    void onRequest(void (*function)(void));
+
+    // Host only - hand bytes to this device as if they came off the bus.  The
+    // onReceive() handler is called the same way the TWI interrupt would.
+    void hostReceive(const uint8_t *data, uint8_t quantity);
+
+    // Host only - the device's TWAR, see above
+    uint8_t &hostAddressRegister(){
+      return addressRegister;
+    }
+
+    // Host only - statistics
+    unsigned long hostTransmissions(){
+      return transmissions;
+    }
+
+    unsigned long hostBytesSent(){
+      return bytesSent;
+    }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,35 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Stand-in for avr-libc's <avr/sleep.h>.                    *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include "../VirtualClock.h"
+
+#define SLEEP_MODE_IDLE      0
+#define SLEEP_MODE_PWR_DOWN  2
+
+inline void set_sleep_mode(uint8_t mode){
+  (void)mode;
+}
+inline void sleep_enable(){}
+inline void sleep_disable(){}
+
+// Every sleep on the host ends at the next millis() tick, which is the one
+// interrupt a sleeping Nano is sure to get.  An I2C message that arrives
+// during the sleep is handled at its own time but only seen by loop() at the tick.
+inline void sleep_cpu(){
+  VirtualClock::advanceMicros(1000 - VirtualClock::nowMicros() % 1000);
+}
+inline void sleep_mode(){
+  sleep_cpu();
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+*****************************************************************************
+*                                                                           *
+*        Project: Wrexus Carduino Controls                                  *
+*          Board: Host (Linux) build                                        *
+*    Description: Entry points of the sketches built for the simulator,     *
+*                 one namespace per board.                                  *
+*                                                                           *
+*****************************************************************************
+*/
+
+#ifndef SIM_BOARDS_H
+#define SIM_BOARDS_H
+
+#include <stdint.h>
+
+namespace simMainMega {
+  void setup();
+  void loop();
+  unsigned int checkSuppressedI2CCommands();
+  uint32_t hudPixel(uint16_t n);
+}
+
+namespace simNano1 {
+  void setup();
+  void loop();
+}
+
+namespace simNano2 {
+  void setup();
+  void loop();
+}
+
+namespace simNano3 {
+  void setup();
+  void loop();
+}
+
+#endif
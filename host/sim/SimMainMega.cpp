@@ -0,0 +1,20 @@
+// Main Mega sketch built into its own namespace so all four boards can be
+// linked into the simulator.  The mock headers are included first, so the
+// sketch's own #includes of them are skipped inside the namespace.
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include <avr/sleep.h>
+
+namespace simMainMega {
+  TwoWire Wire;           // Each board has its own I2C peripheral
+  HardwareSerial Serial;  // and serial port
+
+#include "../../Carduino Network-Main Mega.cpp"
+
+  // Color of an overhead HUD pixel, for the simulator's indicator checks
+  uint32_t hudPixel(uint16_t n){
+    return overheadControlsStrip.getPixelColor(n);
+  }
+}
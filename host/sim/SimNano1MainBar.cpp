@@ -0,0 +1,15 @@
+// Nano 1 (Main Light Bar) sketch built into its own namespace so all four boards can be
+// linked into the simulator.  The mock headers are included first, so the
+// sketch's own #includes of them are skipped inside the namespace.
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <Wire.h>
+#include <avr/sleep.h>
+
+namespace simNano1 {
+  TwoWire Wire;           // Each board has its own I2C peripheral
+  HardwareSerial Serial;  // and serial port
+
+#include "../../Carduino Network-Nano1-Main Bar.cpp"
+}